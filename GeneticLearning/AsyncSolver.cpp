@@ -0,0 +1,131 @@
+#include "AsyncSolver.hpp"
+
+AsyncSolver::AsyncSolver(int amountOfTurns, float mutationRate, int populationSize, int maxGenerationNr, std::chrono::steady_clock::time_point deadline, std::mt19937& generator, const std::string& scramble)
+	: AsyncSolver(GeneticAlgorithm{ amountOfTurns, CubeState(), mutationRate, populationSize, generator, scramble }, maxGenerationNr, deadline)
+{}
+
+AsyncSolver::AsyncSolver(GeneticAlgorithm algorithm, int maxGenerationNr, std::chrono::steady_clock::time_point deadline, const std::string& checkpointFileName, int checkpointInterval)
+	: m_MaxGenerationNr{ maxGenerationNr }
+	, m_CheckpointInterval{ checkpointInterval }
+	, m_Deadline{ deadline }
+	, m_Algorithm{ std::move(algorithm) }
+{
+	if (!checkpointFileName.empty())
+		m_CheckpointWriter.reset(new CheckpointWriter(checkpointFileName));
+
+	m_Scramble = m_Algorithm.GetScramble();
+	m_Result = m_Promise.get_future().share();
+	m_Thread = std::thread(&AsyncSolver::Run, this);
+}
+
+AsyncSolver::~AsyncSolver()
+{
+	Cancel();
+
+	if (m_Thread.joinable())
+		m_Thread.join();
+}
+
+bool AsyncSolver::WaitForImprovement(Improvement& improvement)
+{
+	std::unique_lock<std::mutex> lock{ m_Mutex };
+
+	m_ImprovementFound.wait(lock, [this]() { return !m_Improvements.empty() || m_IsDone; });
+
+	if (m_Improvements.empty())
+		return false;
+
+	improvement = std::move(m_Improvements.front());
+	m_Improvements.pop_front();
+
+	return true;
+}
+
+void AsyncSolver::Run()
+{
+	Result result{};
+	result.generationNr = m_Algorithm.GetCurrentGenerationNr();
+	std::exception_ptr exception{};
+
+	try
+	{
+		int highestFitness{ -1 };
+
+		while (true)
+		{
+			DNA best{ m_Algorithm.GetBest() };
+
+			if (best.GetFitness() > highestFitness)
+			{
+				highestFitness = best.GetFitness();
+				result.best = best;
+				Publish(best, result.generationNr);
+			}
+
+			if (m_Algorithm.GetIsFinnished())
+			{
+				result.isSolved = true;
+				break;
+			}
+
+			if (result.generationNr >= m_MaxGenerationNr || m_IsCancelled || std::chrono::steady_clock::now() >= m_Deadline)
+			{
+				WriteCheckpoint();
+				break;
+			}
+
+			m_Algorithm.NaturalSelection();
+			m_Algorithm.Generate(m_Algorithm.GetAmountOfTurns());
+			m_Algorithm.CalculateFitness();
+			m_Algorithm.ImproveElite();
+
+			++result.generationNr;
+
+			if (m_CheckpointInterval > 0 && result.generationNr % m_CheckpointInterval == 0)
+				WriteCheckpoint();
+		}
+	}
+	catch (...)
+	{
+		exception = std::current_exception();
+	}
+
+	//the last checkpoint is written before the result is handed out, so the result includes whether it failed
+	if (m_CheckpointWriter)
+	{
+		m_CheckpointWriter->Stop();
+		result.hasCheckpointFailed = m_CheckpointWriter->GetHasFailed();
+	}
+
+	if (exception)
+		m_Promise.set_exception(exception);
+	else
+		m_Promise.set_value(result);
+
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		m_IsDone = true;
+	}
+
+	m_ImprovementFound.notify_all();
+}
+
+void AsyncSolver::Publish(const DNA& best, int generationNr)
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		m_Improvements.push_back(Improvement{ best, generationNr, std::chrono::steady_clock::now() });
+	}
+
+	m_ImprovementFound.notify_all();
+}
+
+//the checkpoint is made here between two generations and written to the file by the thread of the writer
+void AsyncSolver::WriteCheckpoint()
+{
+	if (!m_CheckpointWriter)
+		return;
+
+	m_Algorithm.WriteCheckpoint(m_Checkpoint);
+	m_CheckpointWriter->Write(m_Checkpoint);
+}
\ No newline at end of file
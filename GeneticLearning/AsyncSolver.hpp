@@ -0,0 +1,83 @@
+#ifndef ASYNC_SOLVER_HPP
+#define ASYNC_SOLVER_HPP
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "CheckpointWriter.hpp"
+#include "GeneticAlgorithm.hpp"
+
+//runs the genetic algorithm on a background thread
+//every time the best individual improves it is handed out through WaitForImprovement,
+//the improvements are queued so a consumer that is slower than a generation still gets every one of them
+//the run stops at the perfect score, at maxGenerationNr, at the deadline or when Cancel is called
+//and the result then holds the best individual found so far
+//the deadline and Cancel are checked after every generation
+//with a checkpoint file a checkpoint is written every checkpointInterval generations and when the run stops unsolved,
+//a run continues from it by passing GeneticAlgorithm(checkpoint, target) to the second constructor,
+//the result tells whether writing one of the checkpoints failed
+//only run one AsyncSolver at a time, every DNA shares one generator
+class AsyncSolver final
+{
+public:
+	struct Improvement
+	{
+		DNA best{};
+		int generationNr{};
+		std::chrono::steady_clock::time_point timePoint{};
+	};
+
+	struct Result
+	{
+		DNA best{};
+		bool isSolved{};
+		int generationNr{};
+		bool hasCheckpointFailed{};
+	};
+
+	AsyncSolver(int amountOfTurns, float mutationRate, int populationSize, int maxGenerationNr, std::chrono::steady_clock::time_point deadline, std::mt19937& generator, const std::string& scramble = "");
+	AsyncSolver(GeneticAlgorithm algorithm, int maxGenerationNr, std::chrono::steady_clock::time_point deadline, const std::string& checkpointFileName = "", int checkpointInterval = 10);
+	~AsyncSolver();
+
+	AsyncSolver(const AsyncSolver& other) = delete;
+	AsyncSolver& operator=(const AsyncSolver& other) = delete;
+
+	void Cancel() { m_IsCancelled = true; }
+
+	//blocks until there is an improvement that was not handed out yet and returns the oldest one with true,
+	//or returns false when the run is over and every improvement was handed out
+	bool WaitForImprovement(Improvement& improvement);
+
+	std::shared_future<Result> GetResult() const { return m_Result; }
+	const std::string& GetScramble() const { return m_Scramble; }
+
+private:
+	int m_MaxGenerationNr{};
+	int m_CheckpointInterval{};
+	std::chrono::steady_clock::time_point m_Deadline{};
+	std::string m_Scramble{};
+	GeneticAlgorithm m_Algorithm;
+
+	std::unique_ptr<CheckpointWriter> m_CheckpointWriter{};
+	std::vector<char> m_Checkpoint{};
+
+	std::atomic<bool> m_IsCancelled{};
+
+	std::mutex m_Mutex{};
+	std::condition_variable m_ImprovementFound{};
+	std::deque<Improvement> m_Improvements{};
+	bool m_IsDone{};
+
+	std::promise<Result> m_Promise{};
+	std::shared_future<Result> m_Result{};
+	std::thread m_Thread{};
+
+	void Run();
+	void Publish(const DNA& best, int generationNr);
+	void WriteCheckpoint();
+};
+#endif // ASYNC_SOLVER_HPP
\ No newline at end of file
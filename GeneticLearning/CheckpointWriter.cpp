@@ -0,0 +1,101 @@
+#include "CheckpointWriter.hpp"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+CheckpointWriter::CheckpointWriter(const std::string& fileName)
+	: m_FileName{ fileName }
+{
+	m_Thread = std::thread(&CheckpointWriter::Run, this);
+}
+
+CheckpointWriter::~CheckpointWriter()
+{
+	Stop();
+}
+
+void CheckpointWriter::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		m_IsStopping = true;
+	}
+
+	m_CheckpointAdded.notify_all();
+
+	if (m_Thread.joinable())
+		m_Thread.join();
+}
+
+void CheckpointWriter::Write(std::vector<char>& checkpoint)
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		m_Waiting.swap(checkpoint);
+		m_IsWaiting = true;
+	}
+
+	m_CheckpointAdded.notify_all();
+}
+
+bool CheckpointWriter::Read(const std::string& fileName, std::vector<char>& checkpoint)
+{
+	std::ifstream file{ fileName, std::ios::binary };
+
+	if (!file.is_open())
+		return false;
+
+	checkpoint.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+	return !file.bad();
+}
+
+void CheckpointWriter::Run()
+{
+	std::vector<char> checkpoint{};
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock{ m_Mutex };
+
+			m_CheckpointAdded.wait(lock, [this]() { return m_IsWaiting || m_IsStopping; });
+
+			if (!m_IsWaiting)
+				return;
+
+			checkpoint.swap(m_Waiting);
+			m_IsWaiting = false;
+		}
+
+		if (!WriteFile(checkpoint))
+			m_HasFailed = true;
+	}
+}
+
+bool CheckpointWriter::WriteFile(const std::vector<char>& checkpoint) const
+{
+	const std::string temporaryFileName{ m_FileName + ".tmp" };
+
+	{
+		std::ofstream file{ temporaryFileName, std::ios::binary | std::ios::trunc };
+
+		if (!file.is_open())
+			return false;
+
+		file.write(checkpoint.data(), static_cast<std::streamsize>(checkpoint.size()));
+		file.flush();
+
+		if (!file.good())
+			return false;
+	}
+
+#ifdef _WIN32
+	return MoveFileExA(temporaryFileName.c_str(), m_FileName.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	return std::rename(temporaryFileName.c_str(), m_FileName.c_str()) == 0;
+#endif
+}
\ No newline at end of file
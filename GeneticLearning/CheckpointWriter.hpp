@@ -0,0 +1,50 @@
+#ifndef CHECKPOINT_WRITER_HPP
+#define CHECKPOINT_WRITER_HPP
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//writes checkpoints to a file on a background thread so the genetic algorithm does not wait for the disk
+//a checkpoint is first written to fileName.tmp and then moved over fileName,
+//so the file always holds a complete checkpoint even when the process is killed while writing
+class CheckpointWriter final
+{
+public:
+	explicit CheckpointWriter(const std::string& fileName);
+	//writes the checkpoint that is still waiting before returning
+	~CheckpointWriter();
+
+	CheckpointWriter(const CheckpointWriter& other) = delete;
+	CheckpointWriter& operator=(const CheckpointWriter& other) = delete;
+
+	//hands the checkpoint to the writing thread, a checkpoint that is still waiting is replaced
+	//the buffers are swapped, so checkpoint gets a buffer back that can be reused for the next checkpoint
+	void Write(std::vector<char>& checkpoint);
+
+	//writes the checkpoint that is still waiting and stops the writing thread, Write can not be called afterwards
+	void Stop();
+
+	//true when writing one of the checkpoints failed, call Stop first to include the last checkpoint
+	bool GetHasFailed() const { return m_HasFailed; }
+
+	static bool Read(const std::string& fileName, std::vector<char>& checkpoint);
+
+private:
+	std::string m_FileName{};
+
+	std::mutex m_Mutex{};
+	std::condition_variable m_CheckpointAdded{};
+	std::vector<char> m_Waiting{};
+	bool m_IsWaiting{};
+	bool m_IsStopping{};
+	std::atomic<bool> m_HasFailed{};
+
+	std::thread m_Thread{};
+
+	void Run();
+	bool WriteFile(const std::vector<char>& checkpoint) const;
+};
+#endif // CHECKPOINT_WRITER_HPP
\ No newline at end of file
@@ -0,0 +1,454 @@
+#include "CubeEngine.hpp"
+
+//the pieces that move for every side, with an action without ' the piece of cycle[1] goes to cycle[0],
+//cycle[2] to cycle[1], cycle[3] to cycle[2] and cycle[0] to cycle[3] (same as the Rotate functions of CubeState)
+static const uint8_t s_SideCycles[6][4]
+{
+	{ 0, 2, 6, 4 }, //front
+	{ 5, 7, 3, 1 }, //back
+	{ 4, 5, 1, 0 }, //top
+	{ 2, 3, 7, 6 }, //bottom
+	{ 1, 3, 2, 0 }, //left
+	{ 4, 6, 7, 5 }  //right
+};
+
+static const char s_SideNames[6]{ 'F', 'B', 'U', 'D', 'L', 'R' };
+
+//the axis the white/yellow color of a piece faces: 0 = top/bottom, 1 = left/right, 2 = front/back
+//the same axis is a different twist in neighbouring slots because they are mirrored
+static int GetMirror(int slot)
+{
+	const int x{ slot / 4 }, y{ (slot / 2) % 2 }, z{ slot % 2 };
+	return (x + y + z) % 2;
+}
+
+static int ToTwist(int slot, int axis)
+{
+	if (axis == 0)
+		return 0;
+
+	return ((axis == 1) == (GetMirror(slot) == 0)) ? 1 : 2;
+}
+
+//front and back rotate around the front/back axis which swaps top/bottom with left/right,
+//top and bottom swap left/right with front/back and left and right swap top/bottom with front/back
+static int RotateAxis(int side, int axis)
+{
+	const int unchangedAxis{ side < 2 ? 2 : (side < 4 ? 0 : 1) };
+
+	if (axis == unchangedAxis)
+		return axis;
+
+	return 3 - unchangedAxis - axis;
+}
+
+std::vector<uint8_t> CubeEngine::ToActionCodes(const std::string& actions)
+{
+	std::vector<uint8_t> actionCodes{};
+	actionCodes.reserve(actions.size());
+
+	int currentIndex{};
+	const int amountOfCharacters{ static_cast<int>(actions.size()) };
+
+	while (currentIndex < amountOfCharacters)
+	{
+		const bool isPrime{ currentIndex < amountOfCharacters - 1 && actions[currentIndex + 1] == '\'' };
+
+		for (int side{}; side < 6; ++side)
+		{
+			if (actions[currentIndex] == s_SideNames[side])
+			{
+				actionCodes.push_back(static_cast<uint8_t>(side * 2 + (isPrime ? 1 : 0)));
+				break;
+			}
+		}
+
+		currentIndex += isPrime ? 2 : 1;
+	}
+
+	return actionCodes;
+}
+
+std::string CubeEngine::ToString(int actionCode)
+{
+	std::string action(1, s_SideNames[GetSide(actionCode)]);
+
+	if (actionCode % 2 == 1)
+		action += '\'';
+
+	return action;
+}
+
+std::string CubeEngine::ToString(const std::vector<uint8_t>& actionCodes)
+{
+	std::string actions{};
+
+	for (uint8_t actionCode : actionCodes)
+		actions += ToString(actionCode);
+
+	return actions;
+}
+
+FastCube CubeEngine::FromCubeState(const CubeState& cube)
+{
+	FastCube fastCube{};
+
+	for (int slot{}; slot < 8; ++slot)
+	{
+		const std::vector<Color>& colors{ cube.pieces[slot]->colors };
+
+		int x{}, y{}, z{}, axis{};
+
+		for (int colorIndex{}; colorIndex < static_cast<int>(colors.size()); ++colorIndex)
+		{
+			switch (colors[colorIndex])
+			{
+			case Color::red:
+				x = 1;
+				break;
+			case Color::yellow:
+				y = 1;
+				axis = colorIndex >= 4 ? 0 : (colorIndex < 2 ? 1 : 2);
+				break;
+			case Color::white:
+				axis = colorIndex >= 4 ? 0 : (colorIndex < 2 ? 1 : 2);
+				break;
+			case Color::blue:
+				z = 1;
+				break;
+			default:
+				break;
+			}
+		}
+
+		fastCube.pieces[slot] = static_cast<uint8_t>(x * 4 + y * 2 + z);
+		fastCube.twists[slot] = static_cast<uint8_t>(ToTwist(slot, axis));
+	}
+
+	return fastCube;
+}
+
+void CubeEngine::DoAction(FastCube& cube, int actionCode)
+{
+	const ActionTables& actionTables{ GetActionTables() };
+	const std::array<uint8_t, 4>& cycle{ actionTables.cycles[actionCode] };
+	const std::array<uint8_t, 4>& twistChange{ actionTables.twistChanges[actionCode] };
+
+	const uint8_t tempPiece{ cube.pieces[cycle[0]] };
+	const uint8_t tempTwist{ cube.twists[cycle[0]] };
+
+	for (int index{}; index < 3; ++index)
+	{
+		cube.pieces[cycle[index]] = cube.pieces[cycle[index + 1]];
+		cube.twists[cycle[index]] = static_cast<uint8_t>((cube.twists[cycle[index + 1]] + twistChange[index]) % 3);
+	}
+
+	cube.pieces[cycle[3]] = tempPiece;
+	cube.twists[cycle[3]] = static_cast<uint8_t>((tempTwist + twistChange[3]) % 3);
+}
+
+void CubeEngine::DoActions(FastCube& cube, const std::vector<uint8_t>& actionCodes)
+{
+	for (uint8_t actionCode : actionCodes)
+		DoAction(cube, actionCode);
+}
+
+uint32_t CubeEngine::Rank(const FastCube& cube)
+{
+	return RankPermutation(cube.pieces) * amountOfTwists + RankTwists(cube.twists);
+}
+
+FastCube CubeEngine::Unrank(uint32_t rank)
+{
+	FastCube cube{};
+	cube.pieces = UnrankPermutation(rank / amountOfTwists);
+	cube.twists = UnrankTwists(rank % amountOfTwists);
+	return cube;
+}
+
+uint32_t CubeEngine::DoAction(uint32_t rank, int actionCode)
+{
+	const MoveTables& moveTables{ GetMoveTables() };
+
+	const uint32_t permutation{ moveTables.permutations[(rank / amountOfTwists) * amountOfActions + actionCode] };
+	const uint32_t twists{ moveTables.twists[(rank % amountOfTwists) * amountOfActions + actionCode] };
+
+	return permutation * amountOfTwists + twists;
+}
+
+int CubeEngine::GetDistance(uint32_t rank)
+{
+	return GetDistance(GetDistanceTable().distances, rank);
+}
+
+int CubeEngine::GetMaxDistance()
+{
+	return static_cast<int>(GetDistanceTable().amountOfStatesPerDistance.size()) - 1;
+}
+
+uint32_t CubeEngine::GetAmountOfStatesAtDistance(int distance)
+{
+	const std::vector<uint32_t>& amountOfStatesPerDistance{ GetDistanceTable().amountOfStatesPerDistance };
+
+	if (distance < 0 || distance >= static_cast<int>(amountOfStatesPerDistance.size()))
+		return 0;
+
+	return amountOfStatesPerDistance[distance];
+}
+
+std::vector<uint8_t> CubeEngine::Solve(uint32_t rank)
+{
+	std::vector<uint8_t> solution{};
+
+	int distance{ GetDistance(rank) };
+
+	while (distance > 0)
+	{
+		for (int actionCode{}; actionCode < amountOfActions; ++actionCode)
+		{
+			const uint32_t nextRank{ DoAction(rank, actionCode) };
+
+			if (GetDistance(nextRank) < distance)
+			{
+				solution.push_back(static_cast<uint8_t>(actionCode));
+				rank = nextRank;
+				--distance;
+				break;
+			}
+		}
+	}
+
+	return solution;
+}
+
+const CubeEngine::ActionTables& CubeEngine::GetActionTables()
+{
+	static const ActionTables actionTables{ CreateActionTables() };
+	return actionTables;
+}
+
+const CubeEngine::MoveTables& CubeEngine::GetMoveTables()
+{
+	static const MoveTables moveTables{ CreateMoveTables() };
+	return moveTables;
+}
+
+const CubeEngine::DistanceTable& CubeEngine::GetDistanceTable()
+{
+	static const DistanceTable distanceTable{ CreateDistanceTable() };
+	return distanceTable;
+}
+
+CubeEngine::ActionTables CubeEngine::CreateActionTables()
+{
+	ActionTables actionTables{};
+
+	for (int actionCode{}; actionCode < amountOfActions; ++actionCode)
+	{
+		const int side{ GetSide(actionCode) };
+		const bool isPrime{ actionCode % 2 == 1 };
+
+		std::array<uint8_t, 4>& cycle{ actionTables.cycles[actionCode] };
+
+		for (int index{}; index < 4; ++index)
+			cycle[index] = s_SideCycles[side][isPrime ? (4 - index) % 4 : index];
+
+		//a piece that ends up in cycle[index] changes its twist by the twist a piece with twist 0 gets there
+		for (int index{}; index < 4; ++index)
+			actionTables.twistChanges[actionCode][index] = static_cast<uint8_t>(ToTwist(cycle[index], RotateAxis(side, 0)));
+	}
+
+	return actionTables;
+}
+
+CubeEngine::MoveTables CubeEngine::CreateMoveTables()
+{
+	MoveTables moveTables{};
+	moveTables.permutations.resize(amountOfPermutations * amountOfActions);
+	moveTables.twists.resize(amountOfTwists * amountOfActions);
+
+	for (uint32_t permutation{}; permutation < amountOfPermutations; ++permutation)
+	{
+		FastCube cube{};
+		cube.pieces = UnrankPermutation(permutation);
+
+		for (int actionCode{}; actionCode < amountOfActions; ++actionCode)
+		{
+			FastCube nextCube{ cube };
+			DoAction(nextCube, actionCode);
+			moveTables.permutations[permutation * amountOfActions + actionCode] = static_cast<uint16_t>(RankPermutation(nextCube.pieces));
+		}
+	}
+
+	for (uint32_t twists{}; twists < amountOfTwists; ++twists)
+	{
+		FastCube cube{};
+		cube.twists = UnrankTwists(twists);
+
+		for (int actionCode{}; actionCode < amountOfActions; ++actionCode)
+		{
+			FastCube nextCube{ cube };
+			DoAction(nextCube, actionCode);
+			moveTables.twists[twists * amountOfActions + actionCode] = static_cast<uint16_t>(RankTwists(nextCube.twists));
+		}
+	}
+
+	return moveTables;
+}
+
+//breadth first search from the solved cube over the whole state space
+//once most states are found it is cheaper to look from every unfound state for a neighbour in the last layer
+CubeEngine::DistanceTable CubeEngine::CreateDistanceTable()
+{
+	const int unfound{ 15 };
+
+	DistanceTable distanceTable{};
+	std::vector<uint8_t>& distances{ distanceTable.distances };
+	distances.assign(amountOfStates / 2, 0xff);
+
+	SetDistance(distances, 0, 0);
+	distanceTable.amountOfStatesPerDistance.push_back(1);
+
+	uint32_t amountOfFoundStates{ 1 };
+
+	for (int distance{}; amountOfFoundStates < amountOfStates; ++distance)
+	{
+		const bool searchFromUnfound{ amountOfFoundStates > amountOfStates / 2 };
+		uint32_t amountOfNewStates{};
+
+		for (uint32_t rank{}; rank < amountOfStates; ++rank)
+		{
+			if (searchFromUnfound)
+			{
+				if (GetDistance(distances, rank) != unfound)
+					continue;
+
+				for (int actionCode{}; actionCode < amountOfActions; ++actionCode)
+				{
+					if (GetDistance(distances, DoAction(rank, actionCode)) == distance)
+					{
+						SetDistance(distances, rank, distance + 1);
+						++amountOfNewStates;
+						break;
+					}
+				}
+			}
+			else
+			{
+				if (GetDistance(distances, rank) != distance)
+					continue;
+
+				for (int actionCode{}; actionCode < amountOfActions; ++actionCode)
+				{
+					const uint32_t nextRank{ DoAction(rank, actionCode) };
+
+					if (GetDistance(distances, nextRank) == unfound)
+					{
+						SetDistance(distances, nextRank, distance + 1);
+						++amountOfNewStates;
+					}
+				}
+			}
+		}
+
+		if (amountOfNewStates == 0)
+			break;
+
+		distanceTable.amountOfStatesPerDistance.push_back(amountOfNewStates);
+		amountOfFoundStates += amountOfNewStates;
+	}
+
+	return distanceTable;
+}
+
+int CubeEngine::GetDistance(const std::vector<uint8_t>& distances, uint32_t rank)
+{
+	return (distances[rank / 2] >> ((rank % 2) * 4)) & 0xf;
+}
+
+void CubeEngine::SetDistance(std::vector<uint8_t>& distances, uint32_t rank, int distance)
+{
+	const int shift{ static_cast<int>(rank % 2) * 4 };
+	distances[rank / 2] = static_cast<uint8_t>((distances[rank / 2] & ~(0xf << shift)) | (distance << shift));
+}
+
+uint32_t CubeEngine::RankPermutation(const std::array<uint8_t, 8>& pieces)
+{
+	static const uint32_t factorials[8]{ 1, 1, 2, 6, 24, 120, 720, 5040 };
+
+	uint32_t rank{};
+
+	for (int slot{}; slot < 8; ++slot)
+	{
+		uint32_t smallerPiecesAfterSlot{};
+
+		for (int otherSlot{ slot + 1 }; otherSlot < 8; ++otherSlot)
+		{
+			if (pieces[otherSlot] < pieces[slot])
+				++smallerPiecesAfterSlot;
+		}
+
+		rank += smallerPiecesAfterSlot * factorials[7 - slot];
+	}
+
+	return rank;
+}
+
+std::array<uint8_t, 8> CubeEngine::UnrankPermutation(uint32_t rank)
+{
+	static const uint32_t factorials[8]{ 1, 1, 2, 6, 24, 120, 720, 5040 };
+
+	std::array<uint8_t, 8> pieces{};
+	bool isUsed[8]{};
+
+	for (int slot{}; slot < 8; ++slot)
+	{
+		uint32_t smallerPiecesAfterSlot{ rank / factorials[7 - slot] };
+		rank %= factorials[7 - slot];
+
+		for (int pieceIndex{}; pieceIndex < 8; ++pieceIndex)
+		{
+			if (isUsed[pieceIndex])
+				continue;
+
+			if (smallerPiecesAfterSlot == 0)
+			{
+				pieces[slot] = static_cast<uint8_t>(pieceIndex);
+				isUsed[pieceIndex] = true;
+				break;
+			}
+
+			--smallerPiecesAfterSlot;
+		}
+	}
+
+	return pieces;
+}
+
+uint32_t CubeEngine::RankTwists(const std::array<uint8_t, 8>& twists)
+{
+	uint32_t rank{};
+
+	for (int slot{}; slot < 7; ++slot)
+		rank = rank * 3 + twists[slot];
+
+	return rank;
+}
+
+std::array<uint8_t, 8> CubeEngine::UnrankTwists(uint32_t rank)
+{
+	std::array<uint8_t, 8> twists{};
+	int sumOfTwists{};
+
+	for (int slot{ 6 }; slot >= 0; --slot)
+	{
+		twists[slot] = static_cast<uint8_t>(rank % 3);
+		sumOfTwists += twists[slot];
+		rank /= 3;
+	}
+
+	//the twists of a reachable state always add up to a multiple of 3
+	twists[7] = static_cast<uint8_t>((3 - sumOfTwists % 3) % 3);
+
+	return twists;
+}
\ No newline at end of file
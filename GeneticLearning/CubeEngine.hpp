@@ -0,0 +1,99 @@
+#ifndef CUBE_ENGINE_HPP
+#define CUBE_ENGINE_HPP
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "RubiksCube.hpp"
+
+//compact copy of a CubeState for the parts of the program that need millions of actions per second
+//pieces[slot] = the slot the piece has in the solved cube (same slot order as CubeState::pieces)
+//twists[slot] = 0 when the white or yellow color of the piece faces top or bottom, 1 or 2 when it faces a side
+struct FastCube
+{
+	std::array<uint8_t, 8> pieces{ { 0, 1, 2, 3, 4, 5, 6, 7 } };
+	std::array<uint8_t, 8> twists{};
+
+	bool operator==(const FastCube& rhs) const
+	{
+		return pieces == rhs.pieces && twists == rhs.twists;
+	}
+
+	bool operator!=(const FastCube& rhs) const
+	{
+		return !(*this == rhs);
+	}
+};
+
+//action codes follow the order of CubeState::GetRandomAction: F F' B B' U U' D D' L L' R R'
+//so actionCode / 2 is the side that is rotated and actionCode % 2 == 1 for the ' actions
+class CubeEngine final
+{
+public:
+	static const int amountOfActions{ 12 };
+	static const uint32_t amountOfPermutations{ 40320 }; //8!
+	static const uint32_t amountOfTwists{ 2187 }; //3^7, the twist of the last piece follows from the other 7
+	static const uint32_t amountOfStates{ amountOfPermutations * amountOfTwists };
+
+	static int GetInverseActionCode(int actionCode) { return actionCode ^ 1; }
+	static int GetSide(int actionCode) { return actionCode / 2; }
+
+	//reads actions the same way CubeState::Scramble does, characters that are not an action are skipped
+	static std::vector<uint8_t> ToActionCodes(const std::string& actions);
+	static std::string ToString(int actionCode);
+	static std::string ToString(const std::vector<uint8_t>& actionCodes);
+
+	static FastCube FromCubeState(const CubeState& cube);
+
+	static void DoAction(FastCube& cube, int actionCode);
+	static void DoActions(FastCube& cube, const std::vector<uint8_t>& actionCodes);
+
+	//rank = permutation rank * amountOfTwists + twist rank, the solved cube has rank 0
+	static uint32_t Rank(const FastCube& cube);
+	static FastCube Unrank(uint32_t rank);
+
+	//table versions, the tables are built the first time they are needed
+	//the distance table holds every state (44MB) and takes a few seconds to build
+	static uint32_t DoAction(uint32_t rank, int actionCode);
+	static int GetDistance(uint32_t rank);
+	static int GetMaxDistance();
+	static uint32_t GetAmountOfStatesAtDistance(int distance);
+	//an optimal solution for the state
+	static std::vector<uint8_t> Solve(uint32_t rank);
+
+private:
+	struct ActionTables
+	{
+		std::array<std::array<uint8_t, 4>, amountOfActions> cycles{};
+		std::array<std::array<uint8_t, 4>, amountOfActions> twistChanges{};
+	};
+
+	struct MoveTables
+	{
+		std::vector<uint16_t> permutations{};
+		std::vector<uint16_t> twists{};
+	};
+
+	struct DistanceTable
+	{
+		std::vector<uint8_t> distances{}; //4 bits per state
+		std::vector<uint32_t> amountOfStatesPerDistance{};
+	};
+
+	static const ActionTables& GetActionTables();
+	static const MoveTables& GetMoveTables();
+	static const DistanceTable& GetDistanceTable();
+
+	static ActionTables CreateActionTables();
+	static MoveTables CreateMoveTables();
+	static DistanceTable CreateDistanceTable();
+
+	static int GetDistance(const std::vector<uint8_t>& distances, uint32_t rank);
+	static void SetDistance(std::vector<uint8_t>& distances, uint32_t rank, int distance);
+
+	static uint32_t RankPermutation(const std::array<uint8_t, 8>& pieces);
+	static std::array<uint8_t, 8> UnrankPermutation(uint32_t rank);
+	static uint32_t RankTwists(const std::array<uint8_t, 8>& twists);
+	static std::array<uint8_t, 8> UnrankTwists(uint32_t rank);
+};
+#endif // CUBE_ENGINE_HPP
\ No newline at end of file
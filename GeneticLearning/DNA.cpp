@@ -27,6 +27,18 @@ DNA::DNA(int turns, const std::string& ogScramble, const std::string& genes, con
 	//m_Generator = generator;
 }
 
+DNA::DNA(int turns, const std::string& ogScramble, const std::string& genes, int fitness)
+{
+	m_Cube = CubeState();
+	m_Turns = turns;
+	m_Genes = genes;
+	m_Fitness = fitness;
+	//the same cube state as Crossover and Mutate create
+	m_Cube.Scramble(ogScramble);
+	m_Cube.Scramble(m_Genes);
+	m_Scramble = ogScramble;
+}
+
 //calculate fitness score for DNA object
 void DNA::CalculateFitness(const CubeState& target)
 {
@@ -100,10 +112,12 @@ void DNA::Mutate(float mutationRate)
 	
 	std::uniform_int_distribution<unsigned int> distRotations(0, 5);
 	std::uniform_int_distribution<unsigned int> distRotationsAdditionals(0, 6);
+	//draw from the generator instead of rand() so a run can be continued exactly from a checkpoint
+	std::uniform_real_distribution<float> distMutation(0.0f, 1.0f);
 
 	for (int index{}; index < m_Genes.length(); ++index)
 	{
-		if (static_cast<float>(rand()) / RAND_MAX < mutationRate)
+		if (distMutation(m_Generator) < mutationRate)
 		{
 			if (newGenes[index] != '\'')
 				newGenes[index] = rotations[distRotations(m_Generator)];
@@ -11,6 +11,9 @@ public:
 
 	DNA(int turns, const std::string& ogScramble, const std::string& genes, const CubeState& target);
 
+	//for genes from a checkpoint or from LocalSearch, does not draw from the generator or calculate the fitness
+	DNA(int turns, const std::string& ogScramble, const std::string& genes, int fitness);
+
 	//calculate fitness score for DNA object
 	void CalculateFitness(const CubeState& target);
 
@@ -19,6 +22,7 @@ public:
 	void Mutate(float mutationRate);
 
 	static void SetGenerator(std::mt19937& generator) { m_Generator = generator; }
+	static const std::mt19937& GetGenerator() { return m_Generator; }
 	
 	int GetTurns() const { return m_Turns; }
 	int GetFitness() const { return m_Fitness; }
@@ -1,13 +1,122 @@
 #include "GeneticAlgorithm.hpp"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+//every character a genome can have, its index is the 4 bit code in a checkpoint
+static const char geneCharacters[]{ 'F', 'B', 'U', 'D', 'L', 'R', '\'' };
+
+template<typename T>
+static void WriteValue(std::vector<char>& checkpoint, T value)
+{
+	const size_t offset{ checkpoint.size() };
+	checkpoint.resize(offset + sizeof(T));
+	std::memcpy(checkpoint.data() + offset, &value, sizeof(T));
+}
+
+template<typename T>
+static T ReadValue(const std::vector<char>& checkpoint, size_t& offset)
+{
+	if (checkpoint.size() < offset + sizeof(T))
+		throw std::runtime_error("checkpoint is truncated");
+
+	T value{};
+	std::memcpy(&value, checkpoint.data() + offset, sizeof(T));
+	offset += sizeof(T);
+	return value;
+}
+
+static void WriteString(std::vector<char>& checkpoint, const std::string& string)
+{
+	WriteValue(checkpoint, static_cast<uint32_t>(string.size()));
+	checkpoint.insert(checkpoint.end(), string.begin(), string.end());
+}
+
+static std::string ReadString(const std::vector<char>& checkpoint, size_t& offset)
+{
+	const uint32_t size{ ReadValue<uint32_t>(checkpoint, offset) };
+
+	if (checkpoint.size() < offset + size)
+		throw std::runtime_error("checkpoint is truncated");
+
+	std::string string(checkpoint.begin() + offset, checkpoint.begin() + offset + size);
+	offset += size;
+	return string;
+}
+
+//the standard only guarantees the text representation of a generator state
+static void WriteGenerator(std::vector<char>& checkpoint, const std::mt19937& generator)
+{
+	std::ostringstream stream{};
+	stream << generator;
+	WriteString(checkpoint, stream.str());
+}
+
+static std::mt19937 ReadGenerator(const std::vector<char>& checkpoint, size_t& offset)
+{
+	std::istringstream stream{ ReadString(checkpoint, offset) };
+	std::mt19937 generator{};
+	stream >> generator;
+
+	if (stream.fail())
+		throw std::runtime_error("checkpoint has an invalid generator state");
+
+	return generator;
+}
+
+static void WriteGenes(std::vector<char>& checkpoint, const std::string& genes)
+{
+	WriteValue(checkpoint, static_cast<uint16_t>(genes.size()));
+
+	uint8_t packed{};
+
+	for (size_t index{}; index < genes.size(); ++index)
+	{
+		const uint8_t code{ static_cast<uint8_t>(std::find(std::begin(geneCharacters), std::end(geneCharacters), genes[index]) - std::begin(geneCharacters)) };
+
+		if (index % 2 == 0)
+			packed = code;
+		else
+			checkpoint.push_back(static_cast<char>(packed | (code << 4)));
+	}
+
+	if (genes.size() % 2 == 1)
+		checkpoint.push_back(static_cast<char>(packed));
+}
+
+static std::string ReadGenes(const std::vector<char>& checkpoint, size_t& offset)
+{
+	const uint16_t size{ ReadValue<uint16_t>(checkpoint, offset) };
+
+	if (checkpoint.size() < offset + (size + 1) / 2)
+		throw std::runtime_error("checkpoint is truncated");
+
+	std::string genes(size, ' ');
+
+	for (size_t index{}; index < size; ++index)
+	{
+		const uint8_t code{ static_cast<uint8_t>((static_cast<uint8_t>(checkpoint[offset + index / 2]) >> (index % 2 * 4)) & 0xf) };
+
+		if (code >= sizeof(geneCharacters))
+			throw std::runtime_error("checkpoint has an invalid gene");
+
+		genes[index] = geneCharacters[code];
+	}
+
+	offset += (size + 1) / 2;
+	return genes;
+}
 
 GeneticAlgorithm::GeneticAlgorithm(int amountOfTurns, CubeState target, float mutationRate, int populationSize, std::mt19937& generator, const std::string& scramble)
 {
-	if (scramble != "")
+	if (scramble == "")
 		m_Scramble = target.GenerateScramble(amountOfTurns, generator);
 	else m_Scramble = scramble;
 
 	m_Target = target;
 	m_MutationRate = mutationRate;
+	m_AmountOfTurns = amountOfTurns;
 
 	m_Population.resize(populationSize);
 
@@ -22,6 +131,63 @@ GeneticAlgorithm::GeneticAlgorithm(int amountOfTurns, CubeState target, float mu
 	m_PerfectScore = perfect.GetFitness();
 }
 
+GeneticAlgorithm::GeneticAlgorithm(const std::vector<char>& checkpoint, CubeState target)
+{
+	size_t offset{};
+
+	if (ReadValue<uint32_t>(checkpoint, offset) != m_CheckpointMagic || ReadValue<uint32_t>(checkpoint, offset) != m_CheckpointVersion)
+		throw std::runtime_error("checkpoint has an unknown format");
+
+	m_Target = target;
+	m_AmountOfTurns = ReadValue<int32_t>(checkpoint, offset);
+	m_CurrentGenerationNr = ReadValue<int32_t>(checkpoint, offset);
+	m_PerfectScore = ReadValue<int32_t>(checkpoint, offset);
+	m_MutationRate = ReadValue<float>(checkpoint, offset);
+	m_IsFinnished = ReadValue<uint8_t>(checkpoint, offset) != 0;
+	m_Scramble = ReadString(checkpoint, offset);
+
+	m_Generator = ReadGenerator(checkpoint, offset);
+	std::mt19937 dnaGenerator{ ReadGenerator(checkpoint, offset) };
+	DNA::SetGenerator(dnaGenerator);
+
+	const uint32_t populationSize{ ReadValue<uint32_t>(checkpoint, offset) };
+	m_Population.reserve(populationSize);
+
+	for (uint32_t index{}; index < populationSize; ++index)
+	{
+		const int fitness{ ReadValue<uint8_t>(checkpoint, offset) };
+		m_Population.push_back(DNA(m_AmountOfTurns, m_Scramble, ReadGenes(checkpoint, offset), fitness));
+	}
+}
+
+void GeneticAlgorithm::WriteCheckpoint(std::vector<char>& checkpoint) const
+{
+	checkpoint.clear();
+
+	WriteValue(checkpoint, m_CheckpointMagic);
+	WriteValue(checkpoint, m_CheckpointVersion);
+
+	WriteValue(checkpoint, static_cast<int32_t>(m_AmountOfTurns));
+	WriteValue(checkpoint, static_cast<int32_t>(m_CurrentGenerationNr));
+	WriteValue(checkpoint, static_cast<int32_t>(m_PerfectScore));
+	WriteValue(checkpoint, m_MutationRate);
+	WriteValue(checkpoint, static_cast<uint8_t>(m_IsFinnished));
+	WriteString(checkpoint, m_Scramble);
+
+	WriteGenerator(checkpoint, m_Generator);
+	WriteGenerator(checkpoint, DNA::GetGenerator());
+
+	//the mating pool is not written, NaturalSelection creates it again from the population
+	WriteValue(checkpoint, static_cast<uint32_t>(m_Population.size()));
+
+	for (const DNA& dna : m_Population)
+	{
+		//the highest fitness is 16
+		WriteValue(checkpoint, static_cast<uint8_t>(dna.GetFitness()));
+		WriteGenes(checkpoint, dna.GetGenes());
+	}
+}
+
 void GeneticAlgorithm::CalculateFitness()
 {
 	for (DNA& dna : m_Population)
@@ -81,6 +247,53 @@ void GeneticAlgorithm::Generate(int amountOfTurns)
 	++m_CurrentGenerationNr;
 }
 
+void GeneticAlgorithm::ImproveElite()
+{
+	if (m_EliteSize == 0)
+		return;
+
+	//a budget of evaluations instead of time, so the population after a generation does not depend on the load of the machine
+	int amountOfEvaluations{ m_MaxAmountOfLocalSearchEvaluations };
+
+	std::vector<int> indices(m_Population.size());
+
+	for (int index{}; index < static_cast<int>(indices.size()); ++index)
+		indices[index] = index;
+
+	std::stable_sort(indices.begin(), indices.end(), [this](int lhs, int rhs) { return m_Population[lhs].GetFitness() > m_Population[rhs].GetFitness(); });
+
+	//the population holds many copies of the best genomes, each one only has to be improved once
+	std::vector<std::string> improvedGenes{};
+
+	for (int index : indices)
+	{
+		if (static_cast<int>(improvedGenes.size()) == m_EliteSize || amountOfEvaluations <= 0)
+			break;
+
+		const DNA& dna{ m_Population[index] };
+
+		if (std::find(improvedGenes.begin(), improvedGenes.end(), dna.GetGenes()) != improvedGenes.end())
+			continue;
+
+		improvedGenes.push_back(dna.GetGenes());
+
+		std::string genes{ dna.GetGenes() };
+
+		if (m_LocalSearch.Improve(genes, amountOfEvaluations))
+		{
+			m_Population[index] = DNA(m_AmountOfTurns, m_Scramble, genes, 0);
+			m_Population[index].CalculateFitness(m_Target);
+		}
+	}
+}
+
+void GeneticAlgorithm::SetLocalSearch(int eliteSize, int depth, int maxAmountOfEvaluations)
+{
+	m_EliteSize = eliteSize;
+	m_MaxAmountOfLocalSearchEvaluations = maxAmountOfEvaluations;
+	m_LocalSearch = LocalSearch(m_Target, m_Scramble, depth);
+}
+
 DNA GeneticAlgorithm::GetBest()
 {
 	int highestFitnesss{};
@@ -6,8 +6,14 @@
 #include <windows.h>
 #include <fstream>
 #include <string>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
 #include "RubiksCube.hpp"
 #include "GeneticAlgorithm.hpp"
+#include "AsyncSolver.hpp"
+#include "StateSampler.hpp"
+#include "SolutionOptimizer.hpp"
 
 void MoveCursor(int x, int y)
 {
@@ -18,88 +24,92 @@ void MoveCursor(int x, int y)
     SetConsoleCursorPosition(h, c);
 }
 
-int SolveCube(bool printScrambe, std::mt19937& generator, const std::string& scramble, int turns, std::chrono::steady_clock::time_point& timePointHighestFitness)
+//the checkpoint of an attempt only exists while the attempt runs, or when the process was stopped during it
+std::string GetCheckpointFileName(int scrambleNr, int attemptNr)
+{
+    return "GeneticLearning.scramble" + std::to_string(scrambleNr) + ".attempt" + std::to_string(attemptNr) + ".checkpoint";
+}
+
+//continues from the checkpoint in checkpointFileName when it is valid and then sets scramble to the scramble of the checkpoint,
+//otherwise a new run is started
+GeneticAlgorithm CreateAlgorithm(const std::string& checkpointFileName, int turns, float mutationRate, int populationMaxSize, std::mt19937& generator, std::string& scramble)
+{
+    std::vector<char> checkpoint{};
+
+    if (CheckpointWriter::Read(checkpointFileName, checkpoint))
+    {
+        try
+        {
+            GeneticAlgorithm algorithm{ checkpoint, CubeState() };
+            scramble = algorithm.GetScramble();
+
+            std::cout << "Continuing from " << checkpointFileName << " at generation " << algorithm.GetCurrentGenerationNr() << '\n';
+
+            return algorithm;
+        }
+        catch (const std::runtime_error& error)
+        {
+            std::cout << "Ignoring " << checkpointFileName << ": " << error.what() << '\n';
+        }
+    }
+
+    return GeneticAlgorithm{ turns, CubeState(), mutationRate, populationMaxSize, generator, scramble };
+}
+
+//the attempt continues from the checkpoint in checkpointFileName when there is one, see CreateAlgorithm
+int SolveCube(bool printScrambe, std::mt19937& generator, std::string& scramble, int turns, const std::string& checkpointFileName, std::chrono::steady_clock::time_point& timePointHighestFitness, std::string& solution)
 {
-    CubeState target{};
     int populationMaxSize{ 1000 };
     float mutationRate{ 0.2f };
-    int totalGenerations{};
     int maxGenerationNr{ 1000 };
+    std::chrono::seconds timeLimit{ 60 };
+    //local search on the fittest genomes every generation, an eliteSize of 0 runs the plain genetic algorithm
+    int eliteSize{ 10 };
+    int localSearchDepth{ 4 };
+    //sequences evaluated per generation, about 30ms on one core
+    int localSearchEvaluations{ 400'000 };
 
-    GeneticAlgorithm algorithm{ turns, target, mutationRate, populationMaxSize, generator, scramble };
+    GeneticAlgorithm algorithm{ CreateAlgorithm(checkpointFileName, turns, mutationRate, populationMaxSize, generator, scramble) };
+    //the local search settings are not part of a checkpoint
+    algorithm.SetLocalSearch(eliteSize, localSearchDepth, localSearchEvaluations);
 
-    CubeState currBestCube{}, prevBestCube{};
+    AsyncSolver solver{ algorithm, maxGenerationNr, std::chrono::steady_clock::now() + timeLimit, checkpointFileName };
 
     int highestFitness{};
 
-    int generationsOfStagnation{};
-
     /*if (printScrambe)
     {
-        std::cout << "To solve scramble: " << algorithm.GetScramble() << '\n';
-        std::cout << "Fitness goal: " << algorithm.GetPerfectScore() << '\n';
+        std::cout << "To solve scramble: " << solver.GetScramble() << '\n';
     }*/
 
-    while (true)
-    {
-        DNA best{ algorithm.GetBest() };
-        prevBestCube = currBestCube;
-        currBestCube = best.GetCubeState();
-
-        //MoveCursor(0, 3);
+    //the solver runs on its own thread and reports every time its best individual gets better
+    AsyncSolver::Improvement improvement{};
 
-        if (totalGenerations > 2)
-        {
-            if (highestFitness < best.GetFitness())
-            {
-                highestFitness = best.GetFitness();
-                timePointHighestFitness = std::chrono::high_resolution_clock::now();
-            }
-
-            //std::cout << "Best current fitness: " << best.GetFitness() << '\n';
-            //std::cout << "Amount of turns: " << best.GetTurns() - std::count(best.GetGenes().begin(), best.GetGenes().begin() + best.GetTurns(), '\'') << '\n';
-            //std::cout << "Generation: " << totalGenerations << '\n';
-            //std::cout << "Best solve: " << best.GetGenes().substr(0, best.GetTurns()) << '\n';
-        }
-        /*else
-        {
-            std::cout << "                                                         \n";
-            std::cout << "                                                         \n";
-            std::cout << "                                                         \n";
-            std::cout << "                                                         \n";
-        }*/
-
-        if (!algorithm.GetIsFinnished())
-        {
-            algorithm.NaturalSelection();
-            algorithm.Generate(turns);
-            algorithm.CalculateFitness();
-
-            ++totalGenerations;
-
-            if (totalGenerations == maxGenerationNr)
-                return highestFitness;
-        }
-        else
-        {
-            //std::cout << "Finnished at generation: " << totalGenerations << '\n';
-
-            //try to solve the cube with the found solution
-            CubeState toSolveCube{};
+    while (solver.WaitForImprovement(improvement))
+    {
+        highestFitness = improvement.best.GetFitness();
+        timePointHighestFitness = improvement.timePoint;
 
-            toSolveCube.Scramble(algorithm.GetScramble());
+        //std::cout << "Best current fitness: " << highestFitness << '\n';
+        //std::cout << "Generation: " << improvement.generationNr << '\n';
+    }
 
-            toSolveCube.Scramble(std::string(best.GetGenes().begin(), best.GetGenes().begin() + turns));
+    const AsyncSolver::Result result{ solver.GetResult().get() };
 
-            //std::cout << "Genes of best cube: " << best.GetGenes() << '\n';
+    //the attempt starts over when the process is stopped during it
+    if (result.hasCheckpointFailed)
+        std::cout << "Could not save checkpoint to " << checkpointFileName << '\n';
 
-            //std::cout << "Solution was: " << static_cast<char>(toSolveCube == target);
+    if (result.isSolved)
+    {
+        //std::cout << "Finnished at generation: " << result.generationNr << '\n';
 
-            return highestFitness;
-        }
+        //shorten the found solution by removing redundant actions
+        //the cube of a DNA is scrambled with all of its genes, so all of them are part of the solution
+        solution = SolutionOptimizer::Optimize(result.best.GetGenes());
     }
 
-    return false;
+    return highestFitness;
 }
 
 void WriteResultsToFile(std::ofstream& file, int highestFitness, double duration, int attemptNr, const std::string& scramble)
@@ -143,9 +153,26 @@ int main()
 
     DNA::SetGenerator(generator);
 
-    std::ofstream outputFile{ "GeneticLearningResults.csv" };
+    const int amountOfScrambles{ 100 };
+    const int amountOfAttempts{ 10 };
 
     int scrambleNr{};
+    int firstAttemptNr{};
+    bool isResuming{};
+
+    //continue at the attempt that was running when the process was stopped, its checkpoint still exists
+    for (int nr{}; nr < amountOfScrambles * amountOfAttempts && !isResuming; ++nr)
+    {
+        if (std::ifstream{ GetCheckpointFileName(nr / amountOfAttempts, nr % amountOfAttempts) })
+        {
+            scrambleNr = nr / amountOfAttempts;
+            firstAttemptNr = nr % amountOfAttempts;
+            isResuming = true;
+        }
+    }
+
+    //the results of the attempts before the resumed one are kept
+    std::ofstream outputFile{ "GeneticLearningResults.csv", isResuming ? std::ios::app : std::ios::trunc };
 
     int turns{ 30 };
 
@@ -153,19 +180,28 @@ int main()
 
     std::chrono::steady_clock::time_point timePointHighestFitness{}; //this is the time point when the highest fitness was reached
 
-    while (scrambleNr < 100)
+    while (scrambleNr < amountOfScrambles)
     {
-        int attemptNr{};
+        int attemptNr{ firstAttemptNr };
+        firstAttemptNr = 0;
 
-        std::string scramble{ CubeState().GenerateScramble(turns, generator) };
+        //a resumed attempt replaces it with the scramble of its checkpoint
+        std::string scramble{ StateSampler::SampleScramble(generator) };
 
-        while (attemptNr < 10)
+        while (attemptNr < amountOfAttempts)
         {
             std::cout << "Bussy with scramble " << scrambleNr << " attempt " << attemptNr << '\n';
 
             auto startTime = std::chrono::high_resolution_clock::now();
 
-            highestFitness = SolveCube(false, generator, scramble, turns, timePointHighestFitness);
+            std::string solution{};
+
+            const std::string checkpointFileName{ GetCheckpointFileName(scrambleNr, attemptNr) };
+
+            highestFitness = SolveCube(false, generator, scramble, turns, checkpointFileName, timePointHighestFitness, solution);
+
+            if (!solution.empty())
+                std::cout << "Solution: " << solution << '\n';
 
             auto endTime = std::chrono::high_resolution_clock::now();
 
@@ -173,6 +209,9 @@ int main()
 
             WriteResultsToFile(outputFile, highestFitness, duration, attemptNr, scramble);
 
+            //the attempt is done, it is not continued the next time
+            std::remove(checkpointFileName.c_str());
+
             ++attemptNr;
         }
 
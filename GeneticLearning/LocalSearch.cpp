@@ -0,0 +1,133 @@
+#include "LocalSearch.hpp"
+#include <algorithm>
+#include <vector>
+
+LocalSearch::LocalSearch(const CubeState& target, const std::string& scramble, int depth)
+	: m_Target{ CubeEngine::FromCubeState(target) }
+	, m_Depth{ std::min(depth, static_cast<int>(maxDepth)) }
+{
+	CubeEngine::DoActions(m_Scrambled, CubeEngine::ToActionCodes(scramble));
+}
+
+bool LocalSearch::Improve(std::string& genes, int& amountOfEvaluations) const
+{
+	std::vector<uint8_t> actionCodes{ CubeEngine::ToActionCodes(genes) };
+	const int amountOfActions{ static_cast<int>(actionCodes.size()) };
+	const int maxLength{ std::min(m_Depth, amountOfActions) };
+
+	//prefixes[length] = the cube after the scramble and every action except the last length actions
+	std::vector<FastCube> prefixes(maxLength + 1);
+
+	bool hasImproved{};
+
+	while (amountOfEvaluations > 0)
+	{
+		FastCube cube{ m_Scrambled };
+
+		for (int index{}; index < amountOfActions; ++index)
+		{
+			if (amountOfActions - index <= maxLength)
+				prefixes[amountOfActions - index] = cube;
+
+			CubeEngine::DoAction(cube, actionCodes[index]);
+		}
+
+		Candidate best{};
+		best.fitness = GetFitness(cube);
+
+		const int fitnessBefore{ best.fitness };
+
+		//short replacements are tried first, so from replacements with the same fitness the one that keeps most of the genome is used
+		for (int length{ 1 }; length <= maxLength; ++length)
+		{
+			Candidate current{};
+
+			Search(prefixes[length], length, -1, false, current, best, amountOfEvaluations);
+
+			if (amountOfEvaluations <= 0)
+				break;
+		}
+
+		if (best.fitness == fitnessBefore)
+			break;
+
+		std::copy(best.actionCodes.begin(), best.actionCodes.begin() + best.length, actionCodes.end() - best.length);
+
+		hasImproved = true;
+	}
+
+	if (hasImproved)
+		genes = CubeEngine::ToString(actionCodes);
+
+	return hasImproved;
+}
+
+int LocalSearch::GetFitness(const FastCube& cube) const
+{
+	int score{};
+
+	bool layerOne{ true };
+
+	for (int slot{}; slot < 8; ++slot)
+	{
+		const bool equal{ cube.pieces[slot] == m_Target.pieces[slot] && cube.twists[slot] == m_Target.twists[slot] };
+
+		//slots 2, 3, 6 and 7 are the bottom layer
+		const bool isInLayerOne{ (slot & 2) != 0 };
+
+		if (isInLayerOne && !equal)
+			layerOne = false;
+
+		if (equal && layerOne) ++score;
+	}
+
+	if (layerOne)
+		score *= 2;
+
+	return score;
+}
+
+//depth first search over every sequence of length actions
+//sequences that do the same as a shorter sequence are skipped: an action followed by its inverse, the same action 3 times
+//and the two sides of an axis in the other order (F B = B F)
+void LocalSearch::Search(const FastCube& cube, int length, int lastActionCode, bool isRepeated, Candidate& current, Candidate& best, int& amountOfEvaluations) const
+{
+	if (amountOfEvaluations <= 0)
+		return;
+
+	if (current.length == length)
+	{
+		--amountOfEvaluations;
+
+		const int fitness{ GetFitness(cube) };
+
+		if (fitness > best.fitness)
+		{
+			best = current;
+			best.fitness = fitness;
+		}
+
+		return;
+	}
+
+	for (int actionCode{}; actionCode < CubeEngine::amountOfActions; ++actionCode)
+	{
+		if (lastActionCode >= 0)
+		{
+			const int side{ CubeEngine::GetSide(actionCode) }, lastSide{ CubeEngine::GetSide(lastActionCode) };
+
+			if (actionCode == CubeEngine::GetInverseActionCode(lastActionCode) || (actionCode == lastActionCode && isRepeated))
+				continue;
+
+			if (side != lastSide && side / 2 == lastSide / 2 && side < lastSide)
+				continue;
+		}
+
+		FastCube next{ cube };
+		CubeEngine::DoAction(next, actionCode);
+
+		current.actionCodes[current.length++] = static_cast<uint8_t>(actionCode);
+		Search(next, length, actionCode, actionCode == lastActionCode, current, best, amountOfEvaluations);
+		--current.length;
+	}
+}
\ No newline at end of file
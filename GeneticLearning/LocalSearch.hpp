@@ -0,0 +1,41 @@
+#ifndef LOCAL_SEARCH_HPP
+#define LOCAL_SEARCH_HPP
+#include <string>
+#include "CubeEngine.hpp"
+
+//hill climbing on a single genome with the fast cube of CubeEngine
+//every round tries to replace the last 1 to depth actions of the genome with every other sequence of the same length,
+//the replacement that gives the highest fitness is kept and the next round starts from the new genome
+//the search stops when a round finds nothing better or when the budget of evaluated sequences is used,
+//a budget instead of a deadline keeps a run the same on every machine, so it can be repeated and resumed exactly
+//the amount of actions stays the same, Crossover expects genomes of about the same length
+class LocalSearch final
+{
+public:
+	static const int maxDepth{ 4 };
+
+	LocalSearch() = default;
+	LocalSearch(const CubeState& target, const std::string& scramble, int depth);
+
+	//returns true when genes was changed into genes with a higher fitness
+	//every evaluated sequence is taken from amountOfEvaluations, the search stops when it reaches 0
+	bool Improve(std::string& genes, int& amountOfEvaluations) const;
+
+	//the same score as DNA::CalculateFitness
+	int GetFitness(const FastCube& cube) const;
+
+private:
+	FastCube m_Target{};
+	FastCube m_Scrambled{};
+	int m_Depth{};
+
+	struct Candidate
+	{
+		int fitness{};
+		int length{};
+		std::array<uint8_t, maxDepth> actionCodes{};
+	};
+
+	void Search(const FastCube& cube, int length, int lastActionCode, bool isRepeated, Candidate& current, Candidate& best, int& amountOfEvaluations) const;
+};
+#endif // LOCAL_SEARCH_HPP
\ No newline at end of file
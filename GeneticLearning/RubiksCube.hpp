@@ -504,12 +504,12 @@ struct CubeState
 		}
 	}
 
-	bool operator==(const CubeState rhs) const
+	bool operator==(const CubeState& rhs) const
 	{
 		const int amountOfPieces{ static_cast<int>(pieces.size()) };
 		for (int index{}; index < amountOfPieces; ++index)
 		{
-			if (pieces[index] != rhs.pieces[index])
+			if (*pieces[index] != *rhs.pieces[index])
 				return false;
 		}
 
@@ -0,0 +1,225 @@
+#include "SolutionOptimizer.hpp"
+#include <algorithm>
+
+static int GetLength(uint32_t sequence)
+{
+	return static_cast<int>(sequence & 0xf);
+}
+
+static int GetActionCode(uint32_t sequence, int index)
+{
+	return static_cast<int>((sequence >> (4 + index * 4)) & 0xf);
+}
+
+static uint32_t AddActionCode(uint32_t sequence, int actionCode)
+{
+	const int length{ GetLength(sequence) };
+	return ((sequence & ~0xfu) | (static_cast<uint32_t>(actionCode) << (4 + length * 4))) + (length + 1);
+}
+
+std::string SolutionOptimizer::Optimize(const std::string& solution)
+{
+	return CubeEngine::ToString(Optimize(CubeEngine::ToActionCodes(solution)));
+}
+
+std::vector<uint8_t> SolutionOptimizer::Optimize(std::vector<uint8_t> actionCodes)
+{
+	actionCodes = Simplify(std::move(actionCodes));
+
+	while (ReplaceWindows(actionCodes))
+		actionCodes = Simplify(std::move(actionCodes));
+
+	return actionCodes;
+}
+
+std::vector<uint8_t> SolutionOptimizer::Simplify(std::vector<uint8_t> actionCodes)
+{
+	size_t previousSize{};
+
+	do
+	{
+		previousSize = actionCodes.size();
+		actionCodes = SimplifyOnce(actionCodes);
+	} while (actionCodes.size() < previousSize);
+
+	return actionCodes;
+}
+
+//actions on opposite sides do not influence each other (F B = B F), so every run of actions on the same axis
+//is replaced by the net quarter turns of both its sides
+std::vector<uint8_t> SolutionOptimizer::SimplifyOnce(const std::vector<uint8_t>& actionCodes)
+{
+	std::vector<uint8_t> simplified{};
+	simplified.reserve(actionCodes.size());
+
+	const size_t amountOfActions{ actionCodes.size() };
+	size_t index{};
+
+	while (index < amountOfActions)
+	{
+		const int axis{ CubeEngine::GetSide(actionCodes[index]) / 2 };
+		int quarterTurns[2]{};
+
+		while (index < amountOfActions && CubeEngine::GetSide(actionCodes[index]) / 2 == axis)
+		{
+			const int actionCode{ actionCodes[index] };
+			quarterTurns[CubeEngine::GetSide(actionCode) % 2] += actionCode % 2 == 1 ? 3 : 1;
+			++index;
+		}
+
+		for (int sideOfAxis{}; sideOfAxis < 2; ++sideOfAxis)
+		{
+			const uint8_t actionCode{ static_cast<uint8_t>((axis * 2 + sideOfAxis) * 2) };
+
+			switch (quarterTurns[sideOfAxis] % 4)
+			{
+			case 1:
+				simplified.push_back(actionCode);
+				break;
+			case 2:
+				simplified.push_back(actionCode);
+				simplified.push_back(actionCode);
+				break;
+			case 3:
+				simplified.push_back(static_cast<uint8_t>(CubeEngine::GetInverseActionCode(actionCode)));
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	return simplified;
+}
+
+//at every start position the window that saves the most actions is replaced
+//after a replacement the windows that overlap it are checked again
+bool SolutionOptimizer::ReplaceWindows(std::vector<uint8_t>& actionCodes)
+{
+	const SequenceTable& sequenceTable{ GetSequenceTable() };
+
+	bool hasReplaced{};
+	int start{};
+
+	while (start < static_cast<int>(actionCodes.size()))
+	{
+		uint32_t rank{};
+
+		int bestSaving{}, bestWindowSize{};
+		uint32_t bestSequence{};
+
+		const int maxSize{ std::min(static_cast<int>(maxWindowSize), static_cast<int>(actionCodes.size()) - start) };
+
+		for (int windowSize{ 1 }; windowSize <= maxSize; ++windowSize)
+		{
+			rank = CubeEngine::DoAction(rank, actionCodes[start + windowSize - 1]);
+
+			uint32_t sequence{};
+
+			if (sequenceTable.Find(rank, sequence) && windowSize - GetLength(sequence) > bestSaving)
+			{
+				bestSaving = windowSize - GetLength(sequence);
+				bestWindowSize = windowSize;
+				bestSequence = sequence;
+			}
+		}
+
+		if (bestSaving == 0)
+		{
+			++start;
+			continue;
+		}
+
+		std::vector<uint8_t> replacement(GetLength(bestSequence));
+
+		for (int index{}; index < GetLength(bestSequence); ++index)
+			replacement[index] = static_cast<uint8_t>(GetActionCode(bestSequence, index));
+
+		actionCodes.erase(actionCodes.begin() + start, actionCodes.begin() + start + bestWindowSize);
+		actionCodes.insert(actionCodes.begin() + start, replacement.begin(), replacement.end());
+
+		hasReplaced = true;
+		start = std::max(0, start - maxWindowSize + 1);
+	}
+
+	return hasReplaced;
+}
+
+const SolutionOptimizer::SequenceTable& SolutionOptimizer::GetSequenceTable()
+{
+	static const SequenceTable sequenceTable{ CreateSequenceTable() };
+	return sequenceTable;
+}
+
+//breadth first search from the solved cube, the first sequence that reaches a state is an optimal one
+SolutionOptimizer::SequenceTable SolutionOptimizer::CreateSequenceTable()
+{
+	SequenceTable sequenceTable{};
+
+	std::vector<std::pair<uint32_t, uint32_t>> frontier{ { 0, 0 } };
+	std::vector<std::pair<uint32_t, uint32_t>> nextFrontier{};
+	sequenceTable.Insert(0, 0);
+
+	for (int distance{ 1 }; distance <= maxTableDistance; ++distance)
+	{
+		nextFrontier.clear();
+
+		for (const std::pair<uint32_t, uint32_t>& state : frontier)
+		{
+			for (int actionCode{}; actionCode < CubeEngine::amountOfActions; ++actionCode)
+			{
+				const uint32_t nextRank{ CubeEngine::DoAction(state.first, actionCode) };
+				uint32_t sequence{};
+
+				if (!sequenceTable.Find(nextRank, sequence))
+				{
+					sequence = AddActionCode(state.second, actionCode);
+					sequenceTable.Insert(nextRank, sequence);
+					nextFrontier.emplace_back(nextRank, sequence);
+				}
+			}
+		}
+
+		frontier.swap(nextFrontier);
+	}
+
+	return sequenceTable;
+}
+
+//2^19 slots keeps the 246k states up to distance 6 under half load
+SolutionOptimizer::SequenceTable::SequenceTable()
+	: m_Entries(size_t{ 1 } << m_AmountOfBits, ~0ull)
+{}
+
+bool SolutionOptimizer::SequenceTable::Find(uint32_t rank, uint32_t& sequence) const
+{
+	const uint32_t mask{ (1u << m_AmountOfBits) - 1 };
+
+	for (uint32_t slot{ GetSlot(rank) }; m_Entries[slot] != m_Empty; slot = (slot + 1) & mask)
+	{
+		if (static_cast<uint32_t>(m_Entries[slot] >> 32) == rank)
+		{
+			sequence = static_cast<uint32_t>(m_Entries[slot]);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void SolutionOptimizer::SequenceTable::Insert(uint32_t rank, uint32_t sequence)
+{
+	const uint32_t mask{ (1u << m_AmountOfBits) - 1 };
+
+	uint32_t slot{ GetSlot(rank) };
+
+	while (m_Entries[slot] != m_Empty && static_cast<uint32_t>(m_Entries[slot] >> 32) != rank)
+		slot = (slot + 1) & mask;
+
+	m_Entries[slot] = (static_cast<uint64_t>(rank) << 32) | sequence;
+}
+
+uint32_t SolutionOptimizer::SequenceTable::GetSlot(uint32_t rank)
+{
+	return (rank * 2654435761u) >> (32 - m_AmountOfBits);
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef SOLUTION_OPTIMIZER_HPP
+#define SOLUTION_OPTIMIZER_HPP
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CubeEngine.hpp"
+
+//makes solutions shorter without changing what they do to the cube
+//first actions on the same axis are merged or cancelled (F F' and F B F' B' disappear, F F F becomes F')
+//then a window slides over the solution and every part of it that can be done in less actions
+//is replaced by an optimal sequence from a table with every state up to maxTableDistance actions from the solved cube
+class SolutionOptimizer final
+{
+public:
+	static const int maxTableDistance{ 6 };
+	static const int maxWindowSize{ 14 };
+
+	static std::string Optimize(const std::string& solution);
+	static std::vector<uint8_t> Optimize(std::vector<uint8_t> actionCodes);
+
+	static std::vector<uint8_t> Simplify(std::vector<uint8_t> actionCodes);
+
+private:
+	//open addressing hash table from state rank to the optimal sequence that brings the solved cube to that state
+	//every entry is the rank in the upper 32 bits and the sequence in the lower 32 bits,
+	//a sequence is 4 bits for its length followed by 4 bits per action code
+	//a node based map misses the cache on almost every lookup which made it the slowest part of Optimize
+	class SequenceTable final
+	{
+	public:
+		SequenceTable();
+
+		bool Find(uint32_t rank, uint32_t& sequence) const;
+		void Insert(uint32_t rank, uint32_t sequence);
+
+	private:
+		static const int m_AmountOfBits{ 19 };
+		static const uint64_t m_Empty{ ~0ull };
+
+		std::vector<uint64_t> m_Entries{};
+
+		static uint32_t GetSlot(uint32_t rank);
+	};
+
+	static const SequenceTable& GetSequenceTable();
+	static SequenceTable CreateSequenceTable();
+
+	static std::vector<uint8_t> SimplifyOnce(const std::vector<uint8_t>& actionCodes);
+	static bool ReplaceWindows(std::vector<uint8_t>& actionCodes);
+};
+#endif // SOLUTION_OPTIMIZER_HPP
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "StateSampler.hpp"
+#include <algorithm>
+
+uint32_t StateSampler::SampleRank(std::mt19937& generator)
+{
+	std::uniform_int_distribution<uint32_t> dist(1, CubeEngine::amountOfStates - 1);
+	return dist(generator);
+}
+
+uint32_t StateSampler::SampleRank(int distance, std::mt19937& generator)
+{
+	distance = std::max(1, std::min(distance, CubeEngine::GetMaxDistance()));
+
+	//states at rare distances are looked up in a list, for the others drawing until the distance matches is fast enough
+	if (IsRareDistance(distance))
+	{
+		const std::vector<uint32_t>& states{ GetRareStatesPerDistance()[distance] };
+
+		std::uniform_int_distribution<size_t> dist(0, states.size() - 1);
+		return states[dist(generator)];
+	}
+
+	uint32_t rank{ SampleRank(generator) };
+
+	while (CubeEngine::GetDistance(rank) != distance)
+		rank = SampleRank(generator);
+
+	return rank;
+}
+
+std::string StateSampler::SampleScramble(std::mt19937& generator)
+{
+	return ToScramble(SampleRank(generator));
+}
+
+std::string StateSampler::SampleScramble(int distance, std::mt19937& generator)
+{
+	return ToScramble(SampleRank(distance, generator));
+}
+
+std::string StateSampler::ToScramble(uint32_t rank)
+{
+	std::vector<uint8_t> scramble{ CubeEngine::Solve(rank) };
+
+	std::reverse(scramble.begin(), scramble.end());
+
+	for (uint8_t& actionCode : scramble)
+		actionCode = static_cast<uint8_t>(CubeEngine::GetInverseActionCode(actionCode));
+
+	return CubeEngine::ToString(scramble);
+}
+
+const std::vector<std::vector<uint32_t>>& StateSampler::GetRareStatesPerDistance()
+{
+	static const std::vector<std::vector<uint32_t>> rareStatesPerDistance{ CreateRareStatesPerDistance() };
+	return rareStatesPerDistance;
+}
+
+std::vector<std::vector<uint32_t>> StateSampler::CreateRareStatesPerDistance()
+{
+	const int amountOfDistances{ CubeEngine::GetMaxDistance() + 1 };
+
+	std::vector<std::vector<uint32_t>> rareStatesPerDistance(amountOfDistances);
+	std::vector<bool> isRareDistance(amountOfDistances);
+
+	for (int distance{}; distance < amountOfDistances; ++distance)
+		isRareDistance[distance] = IsRareDistance(distance);
+
+	for (uint32_t rank{}; rank < CubeEngine::amountOfStates; ++rank)
+	{
+		const int distance{ CubeEngine::GetDistance(rank) };
+
+		if (isRareDistance[distance])
+			rareStatesPerDistance[distance].push_back(rank);
+	}
+
+	return rareStatesPerDistance;
+}
+
+//a distance is rare when less than 1 in 64 states has it
+bool StateSampler::IsRareDistance(int distance)
+{
+	return static_cast<uint64_t>(CubeEngine::GetAmountOfStatesAtDistance(distance)) * 64 < CubeEngine::amountOfStates;
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#ifndef STATE_SAMPLER_HPP
+#define STATE_SAMPLER_HPP
+#include <random>
+#include <string>
+#include "CubeEngine.hpp"
+
+//draws cube states uniformly by drawing a rank and unranking it instead of replaying random actions like GenerateScramble
+//a distance can be given to only draw states that need exactly that many actions to be solved
+class StateSampler final
+{
+public:
+	//uniform over every state except the solved cube
+	static uint32_t SampleRank(std::mt19937& generator);
+	//uniform over the states exactly distance actions away from the solved cube
+	//distances outside [1, CubeEngine::GetMaxDistance()] are clamped
+	static uint32_t SampleRank(int distance, std::mt19937& generator);
+
+	//a scramble that brings the solved cube to a uniformly drawn state
+	static std::string SampleScramble(std::mt19937& generator);
+	static std::string SampleScramble(int distance, std::mt19937& generator);
+
+	//the scramble is the inverse of an optimal solution, so it is never longer than the distance of the state
+	static std::string ToScramble(uint32_t rank);
+
+private:
+	static const std::vector<std::vector<uint32_t>>& GetRareStatesPerDistance();
+	static std::vector<std::vector<uint32_t>> CreateRareStatesPerDistance();
+	static bool IsRareDistance(int distance);
+};
+#endif // STATE_SAMPLER_HPP
\ No newline at end of file
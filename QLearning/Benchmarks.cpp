@@ -0,0 +1,395 @@
+#include "Training.hpp"
+#include "ValueIteration.hpp"
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <cstdint>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+// Measurements of the training code of Training.hpp and of the relearn policy storages, kept out of QLearning so the agent does not ship them
+
+// Episodes that end in the solved state, so unlike the ones of ExploreEpisode every episode has a reward to learn:
+// a random scramble of 1 to 14 actions from the solved state is undone action by action
+std::vector<EpisodeBatch> CreateSolvingEpisodes(int amountOfEpisodes, unsigned int seed)
+{
+    std::mt19937 generator{ seed };
+    std::uniform_int_distribution<int> lengthDistribution(1, 14);
+    std::uniform_int_distribution<int> actionDistribution(0, CubeEngine::amountOfActions - 1);
+
+    const uint32_t solvedRank{ CubeEngine::Rank(CubeState{}) };
+
+    std::vector<EpisodeBatch> batches((amountOfEpisodes + amountOfEpisodesPerChunk - 1) / amountOfEpisodesPerChunk);
+    std::vector<uint32_t> ranks{};
+    std::vector<int> actionIndices{};
+
+    for (int episodeNr{}; episodeNr < amountOfEpisodes; ++episodeNr)
+    {
+        ranks.assign(1, solvedRank);
+        actionIndices.clear();
+
+        for (int length{ lengthDistribution(generator) }; length > 0; --length)
+        {
+            actionIndices.push_back(actionDistribution(generator));
+            ranks.push_back(CubeEngine::DoAction(ranks.back(), actionIndices.back()));
+        }
+
+        EpisodeBatch& batch{ batches[episodeNr / amountOfEpisodesPerChunk] };
+
+        // the episode ends with the first inverse action that reaches the solved state (at least the last one), which gets the reward
+        for (size_t step{ actionIndices.size() }; step > 0; --step)
+        {
+            const bool solved{ ranks[step - 1] == solvedRank };
+
+            batch.push_back(ranks[step], static_cast<uint8_t>(CubeEngine::GetInverseActionIndex(actionIndices[step - 1])), solved ? 1.0f : 0.0f);
+
+            if (solved)
+                break;
+        }
+
+        batch.end_episode();
+    }
+
+    return batches;
+}
+
+// Learns the same episodes with one thread and with LearnBatches, and prints after every loop how long it took,
+// how many states have an optimal best action and how far the values of LearnBatches are from the serial ones
+void CompareConcurrentTraining(unsigned int amountOfThreads)
+{
+    const int amountOfEpisodes{ 500'000 };
+    const int amountOfTrainLoops{ 5 };
+
+    const std::vector<EpisodeBatch> batches{ CreateSolvingEpisodes(amountOfEpisodes, 1) };
+
+    relearn::q_lambda<State, Action> learner{ 0.5, 0.9, 0.0 };
+
+    Policy serialPolicies{};
+    ConcurrentPolicy concurrentPolicies{};
+    std::vector<float> concurrentValues(CubeIndexer::state_count * CubeIndexer::action_count);
+
+    std::cout << "Learning " << amountOfEpisodes << " episodes serially and on " << amountOfThreads << " threads\n";
+
+    for (int index = 0; index < amountOfTrainLoops; ++index)
+    {
+        auto startTime = std::chrono::high_resolution_clock::now();
+
+        for (const EpisodeBatch& batch : batches)
+        {
+            for (size_t episodeNr{}; episodeNr < batch.size(); ++episodeNr)
+                learner(batch[episodeNr], serialPolicies);
+        }
+
+        auto serialTime{ std::chrono::duration_cast<std::chrono::duration<double>>((std::chrono::high_resolution_clock::now() - startTime)).count() };
+
+        startTime = std::chrono::high_resolution_clock::now();
+
+        LearnBatches(batches, learner, concurrentPolicies, amountOfThreads);
+
+        auto concurrentTime{ std::chrono::duration_cast<std::chrono::duration<double>>((std::chrono::high_resolution_clock::now() - startTime)).count() };
+
+        concurrentPolicies.storage().copy(concurrentValues.data());
+
+        double maxDifference{};
+        for (size_t valueNr{}; valueNr < concurrentValues.size(); ++valueNr)
+            maxDifference = std::max(maxDifference, std::abs(static_cast<double>(serialPolicies.storage().data()[valueNr]) - concurrentValues[valueNr]));
+
+        std::cout << "Loop " << index << ": serial " << serialTime << "s " << GetPercentageOfOptimalStates(serialPolicies) << "% optimal, "
+            << "concurrent " << concurrentTime << "s " << GetPercentageOfOptimalStates(concurrentPolicies) << "% optimal, "
+            << "largest difference " << maxDifference << '\n';
+    }
+}
+
+// Learns the same episodes with relearn::q_learning by replaying them in order and by sampling their transitions from a
+// relearn::prioritized_replay, and prints after every pass how far the values are from the exact ones of ValueIteration
+void CompareReplay()
+{
+    using Transition = relearn::transition<relearn::compact_link<float>>;
+
+    const int amountOfEpisodes{ 200'000 };
+    const int amountOfPasses{ 6 };
+    const size_t amountOfTransitionsPerSample{ 64 };
+
+    const std::vector<EpisodeBatch> batches{ CreateSolvingEpisodes(amountOfEpisodes, 1) };
+
+    size_t amountOfTransitions{};
+    for (const EpisodeBatch& batch : batches)
+    {
+        for (size_t episodeNr{}; episodeNr < batch.size(); ++episodeNr)
+            amountOfTransitions += batch[episodeNr].size();
+    }
+
+    relearn::prioritized_replay<Transition> replay{ amountOfTransitions };
+
+    for (const EpisodeBatch& batch : batches)
+    {
+        for (size_t episodeNr{}; episodeNr < batch.size(); ++episodeNr)
+            replay.push_episode(batch[episodeNr]);
+    }
+
+    relearn::q_learning<State, Action> learner{};
+    learner.alpha = 0.5;
+
+    // ValueIteration gives the solved cube itself the reward, the episodes give it to the action that reaches it,
+    // so the values the learner converges to are the ones of ValueIteration divided by the discount rate
+    std::vector<float> exactValues{};
+    ValueIteration::Solve(static_cast<float>(learner.gamma), 1e-6f, 100, 1, exactValues);
+
+    for (float& exactValue : exactValues)
+        exactValue /= static_cast<float>(learner.gamma);
+
+    // the mean distance to the exact values of the states and actions that were learned
+    auto getError = [&exactValues](const Policy& policies)
+    {
+        double error{};
+        size_t amountOfValues{};
+
+        for (size_t valueNr{}; valueNr < exactValues.size(); ++valueNr)
+        {
+            const float value{ policies.storage().data()[valueNr] };
+
+            if (value == Policy::storage_type::unvisited())
+                continue;
+
+            error += std::abs(value - exactValues[valueNr]);
+            ++amountOfValues;
+        }
+
+        return error / std::max<size_t>(1, amountOfValues);
+    };
+
+    Policy replayedPolicies{};
+    Policy prioritizedPolicies{};
+
+    std::mt19937 generator{ 1 };
+    std::vector<size_t> indices{};
+    std::vector<double> errors(amountOfTransitionsPerSample);
+
+    std::cout << "Learning " << amountOfTransitions << " transitions per pass\n";
+
+    for (int pass{}; pass < amountOfPasses; ++pass)
+    {
+        for (const EpisodeBatch& batch : batches)
+        {
+            for (size_t episodeNr{}; episodeNr < batch.size(); ++episodeNr)
+                learner(batch[episodeNr], replayedPolicies);
+        }
+
+        // as many updates as the replayed pass
+        for (size_t amountOfUpdates{}; amountOfUpdates < amountOfTransitions; amountOfUpdates += amountOfTransitionsPerSample)
+        {
+            replay.sample(amountOfTransitionsPerSample, generator, indices);
+
+            for (size_t sampleNr{}; sampleNr < indices.size(); ++sampleNr)
+                errors[sampleNr] = learner(replay[indices[sampleNr]], prioritizedPolicies);
+
+            replay.update(indices, errors);
+        }
+
+        std::cout << "Pass " << pass << ": replayed error " << getError(replayedPolicies) << ", prioritized error " << getError(prioritizedPolicies) << '\n';
+    }
+}
+
+// Learns the same amount of episodes per round with episodes from any state (like TrainAgent) and with the curriculum of
+// TrainAgentWithCurriculum and prints how many random states the best actions of both policies solve
+void CompareCurriculumTraining()
+{
+    const int amountOfRounds{ 60 };
+    const double solveRateThreshold{ 0.95 };
+    const int amountOfEvaluatedStates{ 1000 };
+
+    relearn::q_lambda<State, Action> learner{ 0.9, 0.9, 0.0 };
+
+    ConcurrentPolicy randomPolicies{};
+    ConcurrentPolicy curriculumPolicies{};
+
+    std::mt19937 generator{ 1 };
+    double randomTime{};
+    double curriculumTime{};
+    int distance{ 1 };
+
+    std::cout << "Learning " << amountOfCurriculumEpisodesPerRound << " episodes per round from any state and with a curriculum\n";
+
+    for (int round{}; round < amountOfRounds; ++round)
+    {
+        auto startTime = std::chrono::high_resolution_clock::now();
+
+        LearnCurriculumRound(learner, randomPolicies, 0, static_cast<unsigned int>(round), 1, nullptr);
+
+        randomTime += std::chrono::duration_cast<std::chrono::duration<double>>((std::chrono::high_resolution_clock::now() - startTime)).count();
+        startTime = std::chrono::high_resolution_clock::now();
+
+        LearnCurriculumRound(learner, curriculumPolicies, distance, static_cast<unsigned int>(round), 1, nullptr);
+
+        if (GetGreedySolveRate(curriculumPolicies, distance, amountOfEvaluatedStates, maxAmountOfCurriculumMoves, generator) >= solveRateThreshold)
+            distance = std::min(distance + 1, CubeEngine::GetMaxDistance());
+
+        curriculumTime += std::chrono::duration_cast<std::chrono::duration<double>>((std::chrono::high_resolution_clock::now() - startTime)).count();
+
+        if (round % 5 == 4)
+        {
+            std::cout << "Round " << round + 1 << ": from any state " << randomTime << "s "
+                << 100.0 * GetGreedySolveRate(randomPolicies, 0, amountOfEvaluatedStates, maxAmountOfCurriculumMoves, generator) << "% solved, "
+                << "curriculum at distance " << distance << " " << curriculumTime << "s "
+                << 100.0 * GetGreedySolveRate(curriculumPolicies, 0, amountOfEvaluatedStates, maxAmountOfCurriculumMoves, generator) << "% solved\n";
+        }
+    }
+}
+
+// State for the storage benchmark: a plain id, so the storages are compared and not the hashing of CubeState
+using BenchmarkState = relearn::state<uint64_t>;
+
+template <std::size_t amountOfStates>
+struct BenchmarkIndexer
+{
+    static const std::size_t state_count{ amountOfStates };
+    static const std::size_t action_count{ CubeIndexer::action_count };
+
+    static std::size_t state_index(const BenchmarkState& state) { return static_cast<std::size_t>(state.trait()); }
+    static BenchmarkState state_at(std::size_t stateIndex) { return BenchmarkState(stateIndex); }
+    static std::size_t action_index(const Action& action) { return CubeIndexer::action_index(action); }
+    static Action action_at(std::size_t actionIndex) { return CubeIndexer::action_at(actionIndex); }
+};
+
+// Physical memory that is free now, 0 when it is unknown
+uint64_t GetAvailableMemory()
+{
+#ifdef _WIN32
+    MEMORYSTATUSEX status{};
+    status.dwLength = sizeof(status);
+
+    return GlobalMemoryStatusEx(&status) ? status.ullAvailPhys : 0;
+#else
+    const long amountOfPages{ sysconf(_SC_AVPHYS_PAGES) };
+    const long pageSize{ sysconf(_SC_PAGESIZE) };
+
+    return amountOfPages > 0 && pageSize > 0 ? static_cast<uint64_t>(amountOfPages) * static_cast<uint64_t>(pageSize) : 0;
+#endif
+}
+
+// Gives every state one value and then does 10 million Q-learning updates (value, best_value of the next state, update)
+// on random states. It is skipped when bytesPerState times amountOfStates does not fit in the free memory, instead of
+// letting the process run out of memory.
+template <class BenchmarkPolicy>
+void BenchmarkPolicyStorage(const std::string& name, uint64_t amountOfStates, uint64_t bytesPerState)
+{
+    const uint64_t availableMemory{ GetAvailableMemory() };
+
+    if (availableMemory != 0 && amountOfStates * bytesPerState > availableMemory)
+    {
+        std::cout << name << " with " << amountOfStates << " states: skipped, needs about " << amountOfStates * bytesPerState / (1024 * 1024)
+            << "MB and " << availableMemory / (1024 * 1024) << "MB is free\n";
+        return;
+    }
+
+    std::mt19937_64 generator{ amountOfStates };
+    std::uniform_int_distribution<uint64_t> stateDistribution(0, amountOfStates - 1);
+    std::uniform_int_distribution<int> actionDistribution(0, CubeEngine::amountOfActions - 1);
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    BenchmarkPolicy policies{};
+
+    for (uint64_t stateId{}; stateId < amountOfStates; ++stateId)
+        policies.update(BenchmarkState(stateId), CubeIndexer::action_at(actionDistribution(generator)), 0.0f);
+
+    auto fillTime{ std::chrono::duration_cast<std::chrono::duration<double>>((std::chrono::high_resolution_clock::now() - startTime)).count() };
+
+    const int amountOfUpdates{ 10'000'000 };
+    float checksum{};
+
+    startTime = std::chrono::high_resolution_clock::now();
+
+    for (int update{}; update < amountOfUpdates; ++update)
+    {
+        BenchmarkState state(stateDistribution(generator));
+        BenchmarkState next(stateDistribution(generator));
+        Action action{ CubeIndexer::action_at(actionDistribution(generator)) };
+
+        float q = policies.value(state, action);
+        float qNext = policies.best_value(next);
+
+        if (std::isnan(qNext))
+            qNext = 0.0f;
+
+        policies.update(state, action, q + 0.5f * (1.0f + 0.9f * qNext - q));
+        checksum += q;
+    }
+
+    auto updateTime{ std::chrono::duration_cast<std::chrono::duration<double>>((std::chrono::high_resolution_clock::now() - startTime)).count() };
+
+    std::cout << name << " with " << amountOfStates << " states: filled in " << fillTime << "s, "
+        << updateTime * 1e9 / amountOfUpdates << "ns per update (checksum " << checksum << ")\n";
+}
+
+// After the updates the nested maps use about 430 bytes per state (4GB for 10 million states, 20GB for 50 million),
+// the flat map about 100 and the dense array 48. The nested maps run last, so the others have their results when they
+// do not fit.
+template <std::size_t amountOfStates>
+void BenchmarkPolicyStorages()
+{
+    BenchmarkPolicyStorage<relearn::dense_policy<BenchmarkState, Action, BenchmarkIndexer<amountOfStates>>>("dense array", amountOfStates, 48);
+    BenchmarkPolicyStorage<relearn::flat_policy<BenchmarkState, Action, BenchmarkIndexer<amountOfStates>>>("flat map", amountOfStates, 100);
+    BenchmarkPolicyStorage<relearn::policy<BenchmarkState, Action, float>>("nested maps", amountOfStates, 430);
+}
+
+void BenchmarkPolicyStorages()
+{
+    BenchmarkPolicyStorages<1'000'000>();
+    BenchmarkPolicyStorages<10'000'000>();
+    BenchmarkPolicyStorages<50'000'000>();
+}
+
+void PrintUsage()
+{
+    std::cout << "Usage:\n"
+        << "  QLearningBenchmarks concurrent   compares learning on one thread with LearnBatches, see CompareConcurrentTraining\n"
+        << "  QLearningBenchmarks replay       compares replaying episodes with a prioritized replay, see CompareReplay\n"
+        << "  QLearningBenchmarks curriculum   compares learning from any state with a curriculum, see CompareCurriculumTraining\n"
+        << "  QLearningBenchmarks storage      compares the speed of the policy storages, see BenchmarkPolicyStorages\n";
+}
+
+// QLearningBenchmarks <benchmark>   runs the benchmark
+// Other arguments print the usage and return 1
+int main(int argc, char* argv[])
+{
+    const std::vector<std::string> arguments(argv + 1, argv + argc);
+
+    if (arguments.size() == 1 && arguments[0] == "concurrent")
+    {
+        CompareConcurrentTraining(std::max(1u, std::thread::hardware_concurrency()));
+        return 0;
+    }
+
+    if (arguments.size() == 1 && arguments[0] == "replay")
+    {
+        CompareReplay();
+        return 0;
+    }
+
+    if (arguments.size() == 1 && arguments[0] == "curriculum")
+    {
+        CompareCurriculumTraining();
+        return 0;
+    }
+
+    if (arguments.size() == 1 && arguments[0] == "storage")
+    {
+        BenchmarkPolicyStorages();
+        return 0;
+    }
+
+    PrintUsage();
+    return 1;
+}
@@ -0,0 +1,117 @@
+#ifndef BOUNDEDQUEUE_HPP
+#define BOUNDEDQUEUE_HPP
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+
+//BoundedQueue is a lock-free queue with a fixed capacity for any amount of producing and consuming threads.
+//Every cell has a sequence number that tells whose turn it is: a producer may fill a cell when its sequence equals
+//the position being pushed, a consumer may empty it when its sequence is one higher. Positions are claimed with a
+//compare exchange, so threads only wait on each other when the queue is full or empty.
+template<typename T>
+class BoundedQueue final
+{
+public:
+	//the capacity is rounded up to a power of two
+	explicit BoundedQueue(size_t capacity)
+	{
+		size_t amountOfCells{ 1 };
+		while (amountOfCells < capacity)
+			amountOfCells *= 2;
+
+		m_pCells = std::make_unique<Cell[]>(amountOfCells);
+		m_Mask = amountOfCells - 1;
+
+		for (size_t position{}; position < amountOfCells; ++position)
+			m_pCells[position].sequence.store(position, std::memory_order_relaxed);
+	}
+
+	BoundedQueue(const BoundedQueue& other) = delete;
+	BoundedQueue& operator=(const BoundedQueue& other) = delete;
+
+	//moves value into the queue, false when the queue is full
+	bool TryPush(T& value)
+	{
+		size_t position{ m_PushPosition.load(std::memory_order_relaxed) };
+
+		while (true)
+		{
+			Cell& cell{ m_pCells[position & m_Mask] };
+			const size_t sequence{ cell.sequence.load(std::memory_order_acquire) };
+			const std::ptrdiff_t difference{ static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position) };
+
+			if (difference == 0)
+			{
+				if (m_PushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					cell.value = std::move(value);
+					cell.sequence.store(position + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			//the cell still holds a value from the previous round
+			else if (difference < 0)
+				return false;
+			else
+				position = m_PushPosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	//moves the oldest value out of the queue, false when the queue is empty
+	bool TryPop(T& value)
+	{
+		size_t position{ m_PopPosition.load(std::memory_order_relaxed) };
+
+		while (true)
+		{
+			Cell& cell{ m_pCells[position & m_Mask] };
+			const size_t sequence{ cell.sequence.load(std::memory_order_acquire) };
+			const std::ptrdiff_t difference{ static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1) };
+
+			if (difference == 0)
+			{
+				if (m_PopPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					value = std::move(cell.value);
+					cell.sequence.store(position + m_Mask + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			//the cell has not been filled yet
+			else if (difference < 0)
+				return false;
+			else
+				position = m_PopPosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	//TryPush until it succeeds, yielding while the queue is full
+	void Push(T& value)
+	{
+		while (!TryPush(value))
+			std::this_thread::yield();
+	}
+
+	//TryPop until it succeeds, yielding while the queue is empty
+	void Pop(T& value)
+	{
+		while (!TryPop(value))
+			std::this_thread::yield();
+	}
+
+private:
+	struct Cell
+	{
+		std::atomic<size_t> sequence;
+		T value;
+	};
+
+	std::unique_ptr<Cell[]> m_pCells{};
+	size_t m_Mask{};
+
+	//on their own cache lines, so producers and consumers do not invalidate each other's position
+	alignas(64) std::atomic<size_t> m_PushPosition{};
+	alignas(64) std::atomic<size_t> m_PopPosition{};
+};
+#endif // BOUNDEDQUEUE_HPP
\ No newline at end of file
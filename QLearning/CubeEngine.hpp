@@ -0,0 +1,297 @@
+#ifndef CUBEENGINE_HPP
+#define CUBEENGINE_HPP
+#include "RubiksCube.hpp"
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+//CubeEngine works on a compact copy of a CubeState: for every slot the index of the piece in it,
+//where the index of a piece is the slot it has in the solved cube.
+//The pieces of this cube model are moved around but never turned, so every state is a permutation of 8 pieces
+//and can be ranked into [0, 8!). Rank 0 is the solved cube.
+//All tables are built the first time they are needed.
+struct CubeEngine
+{
+	static const uint32_t amountOfStates{ 40320 };
+	static const int amountOfActions{ 12 };
+	static const int amountOfPieces{ 8 };
+
+	using Pieces = std::array<uint8_t, amountOfPieces>;
+
+	//an action index is the exponent of its CubeActionPosibilities value (rotateRightCW = 0 counts as 2^0)
+	//so 0-5 are the clockwise rotations and 6-11 the same rotations counterclockwise
+	static int ToActionIndex(CubeAction action)
+	{
+		int actionIndex{};
+		unsigned int value{ static_cast<unsigned int>(action.action) };
+
+		while (value > 1)
+		{
+			value >>= 1;
+			++actionIndex;
+		}
+
+		return actionIndex;
+	}
+
+	static CubeAction ToAction(int actionIndex)
+	{
+		return CubeAction(static_cast<CubeActionPosibilities>(actionIndex == 0 ? 0 : 1 << actionIndex));
+	}
+
+	static int GetInverseActionIndex(int actionIndex)
+	{
+		return (actionIndex + amountOfActions / 2) % amountOfActions;
+	}
+
+	static Pieces ToPieces(const CubeState& cube)
+	{
+		const CubeState& solved{ GetSolvedState() };
+
+		Pieces pieces{};
+
+		for (int slot{}; slot < amountOfPieces; ++slot)
+		{
+			for (int pieceIndex{}; pieceIndex < amountOfPieces; ++pieceIndex)
+			{
+				if (*cube.pieces[slot] == *solved.pieces[pieceIndex])
+				{
+					pieces[slot] = static_cast<uint8_t>(pieceIndex);
+					break;
+				}
+			}
+		}
+
+		return pieces;
+	}
+
+	//the returned CubeState has freshly made pieces, like a CubeState that was just constructed
+	static CubeState ToCubeState(const Pieces& pieces)
+	{
+		CubeState cube{};
+		const std::vector<std::shared_ptr<Piece>> solvedPieces{ cube.pieces };
+
+		for (int slot{}; slot < amountOfPieces; ++slot)
+			cube.pieces[slot] = solvedPieces[pieces[slot]];
+
+		cube.Recalculate();
+
+		return cube;
+	}
+
+	//lehmer code of the permutation
+	static uint32_t Rank(const Pieces& pieces)
+	{
+		uint32_t rank{};
+
+		for (int slot{}; slot < amountOfPieces; ++slot)
+		{
+			uint32_t smallerPiecesAfterSlot{};
+
+			for (int otherSlot{ slot + 1 }; otherSlot < amountOfPieces; ++otherSlot)
+			{
+				if (pieces[otherSlot] < pieces[slot])
+					++smallerPiecesAfterSlot;
+			}
+
+			rank += smallerPiecesAfterSlot * GetFactorial(amountOfPieces - 1 - slot);
+		}
+
+		return rank;
+	}
+
+	static uint32_t Rank(const CubeState& cube)
+	{
+		return Rank(ToPieces(cube));
+	}
+
+	static Pieces Unrank(uint32_t rank)
+	{
+		Pieces pieces{};
+		bool isUsed[amountOfPieces]{};
+
+		for (int slot{}; slot < amountOfPieces; ++slot)
+		{
+			const uint32_t factorial{ GetFactorial(amountOfPieces - 1 - slot) };
+			uint32_t smallerPiecesAfterSlot{ rank / factorial };
+			rank %= factorial;
+
+			for (int pieceIndex{}; pieceIndex < amountOfPieces; ++pieceIndex)
+			{
+				if (isUsed[pieceIndex])
+					continue;
+
+				if (smallerPiecesAfterSlot == 0)
+				{
+					pieces[slot] = static_cast<uint8_t>(pieceIndex);
+					isUsed[pieceIndex] = true;
+					break;
+				}
+
+				--smallerPiecesAfterSlot;
+			}
+		}
+
+		return pieces;
+	}
+
+	//same slot cycles as the Rotate functions of CubeState
+	static void DoAction(Pieces& pieces, int actionIndex)
+	{
+		const std::array<uint8_t, 4>& cycle{ GetCycles()[actionIndex % (amountOfActions / 2)] };
+		const bool clockWise{ actionIndex < amountOfActions / 2 };
+
+		if (clockWise)
+		{
+			const uint8_t tempPiece{ pieces[cycle[0]] };
+			pieces[cycle[0]] = pieces[cycle[1]];
+			pieces[cycle[1]] = pieces[cycle[2]];
+			pieces[cycle[2]] = pieces[cycle[3]];
+			pieces[cycle[3]] = tempPiece;
+		}
+		else
+		{
+			const uint8_t tempPiece{ pieces[cycle[3]] };
+			pieces[cycle[3]] = pieces[cycle[2]];
+			pieces[cycle[2]] = pieces[cycle[1]];
+			pieces[cycle[1]] = pieces[cycle[0]];
+			pieces[cycle[0]] = tempPiece;
+		}
+	}
+
+	static uint32_t DoAction(uint32_t rank, int actionIndex)
+	{
+		return GetMoveTable()[rank * amountOfActions + actionIndex];
+	}
+
+	//minimum amount of actions needed to solve the state
+	static int GetDistance(uint32_t rank)
+	{
+		return GetDistanceTable()[rank];
+	}
+
+	static int GetMaxDistance()
+	{
+		const std::vector<uint8_t>& distances{ GetDistanceTable() };
+		return *std::max_element(distances.begin(), distances.end());
+	}
+
+	//an optimal solution for the state as action indices
+	static std::vector<int> Solve(uint32_t rank)
+	{
+		std::vector<int> solution{};
+
+		while (GetDistance(rank) > 0)
+		{
+			for (int actionIndex{}; actionIndex < amountOfActions; ++actionIndex)
+			{
+				const uint32_t nextRank{ DoAction(rank, actionIndex) };
+
+				if (GetDistance(nextRank) < GetDistance(rank))
+				{
+					solution.push_back(actionIndex);
+					rank = nextRank;
+					break;
+				}
+			}
+		}
+
+		return solution;
+	}
+
+private:
+	static uint32_t GetFactorial(int number)
+	{
+		static const uint32_t factorials[amountOfPieces]{ 1, 1, 2, 6, 24, 120, 720, 5040 };
+		return factorials[number];
+	}
+
+	static const CubeState& GetSolvedState()
+	{
+		static const CubeState solved{};
+		return solved;
+	}
+
+	//clockwise: the piece of cycle[1] goes to cycle[0], cycle[2] to cycle[1], cycle[3] to cycle[2] and cycle[0] to cycle[3]
+	static const std::array<std::array<uint8_t, 4>, 6>& GetCycles()
+	{
+		static const std::array<std::array<uint8_t, 4>, 6> cycles
+		{ {
+			{ 1, 3, 7, 5 }, //right
+			{ 0, 4, 6, 2 }, //left
+			{ 0, 2, 3, 1 }, //front
+			{ 4, 5, 7, 6 }, //back
+			{ 0, 1, 5, 4 }, //top
+			{ 2, 6, 7, 3 }  //bottom
+		} };
+
+		return cycles;
+	}
+
+	static const std::vector<uint32_t>& GetMoveTable()
+	{
+		static const std::vector<uint32_t> moveTable{ CreateMoveTable() };
+		return moveTable;
+	}
+
+	static const std::vector<uint8_t>& GetDistanceTable()
+	{
+		static const std::vector<uint8_t> distanceTable{ CreateDistanceTable() };
+		return distanceTable;
+	}
+
+	static std::vector<uint32_t> CreateMoveTable()
+	{
+		std::vector<uint32_t> moveTable(amountOfStates * amountOfActions);
+
+		for (uint32_t rank{}; rank < amountOfStates; ++rank)
+		{
+			const Pieces pieces{ Unrank(rank) };
+
+			for (int actionIndex{}; actionIndex < amountOfActions; ++actionIndex)
+			{
+				Pieces nextPieces{ pieces };
+				DoAction(nextPieces, actionIndex);
+				moveTable[rank * amountOfActions + actionIndex] = Rank(nextPieces);
+			}
+		}
+
+		return moveTable;
+	}
+
+	//breadth first search from the solved cube
+	static std::vector<uint8_t> CreateDistanceTable()
+	{
+		const uint8_t unvisited{ 0xff };
+		std::vector<uint8_t> distanceTable(amountOfStates, unvisited);
+
+		std::vector<uint32_t> frontier{ 0 };
+		std::vector<uint32_t> nextFrontier{};
+		distanceTable[0] = 0;
+
+		for (uint8_t distance{ 1 }; !frontier.empty(); ++distance)
+		{
+			nextFrontier.clear();
+
+			for (uint32_t rank : frontier)
+			{
+				for (int actionIndex{}; actionIndex < amountOfActions; ++actionIndex)
+				{
+					const uint32_t nextRank{ DoAction(rank, actionIndex) };
+
+					if (distanceTable[nextRank] == unvisited)
+					{
+						distanceTable[nextRank] = distance;
+						nextFrontier.push_back(nextRank);
+					}
+				}
+			}
+
+			frontier.swap(nextFrontier);
+		}
+
+		return distanceTable;
+	}
+};
+#endif // CUBEENGINE_HPP
\ No newline at end of file
@@ -0,0 +1,34 @@
+#ifndef CUBEINDEXER_HPP
+#define CUBEINDEXER_HPP
+#include "CubeEngine.hpp"
+#include <cstddef>
+
+//CubeIndexer maps the states and actions of relearn to the indices of relearn::dense_policy.
+//A state is its permutation rank and an action is its action index, so the Q-values of every state
+//of this cube model fit in 40320 * 12 floats (1.9MB, 48 bytes per state).
+struct CubeIndexer
+{
+	static const std::size_t state_count{ CubeEngine::amountOfStates };
+	static const std::size_t action_count{ CubeEngine::amountOfActions };
+
+	static std::size_t state_index(const relearn::state<CubeState>& state)
+	{
+		return CubeEngine::Rank(state.trait());
+	}
+
+	static relearn::state<CubeState> state_at(std::size_t stateIndex)
+	{
+		return relearn::state<CubeState>(CubeEngine::ToCubeState(CubeEngine::Unrank(static_cast<uint32_t>(stateIndex))));
+	}
+
+	static std::size_t action_index(const relearn::action<CubeAction>& action)
+	{
+		return static_cast<std::size_t>(CubeEngine::ToActionIndex(action.trait()));
+	}
+
+	static relearn::action<CubeAction> action_at(std::size_t actionIndex)
+	{
+		return relearn::action<CubeAction>(CubeEngine::ToAction(static_cast<int>(actionIndex)));
+	}
+};
+#endif // CUBEINDEXER_HPP
\ No newline at end of file
@@ -0,0 +1,248 @@
+#ifndef POLICYCHECKPOINTER_HPP
+#define POLICYCHECKPOINTER_HPP
+#include "PolicyFile.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+//PolicyCheckpointer writes the values of a dense policy on a background thread, so training only waits for a copy of them.
+//The first checkpoint is a full PolicyFile (the base), the next ones are a delta file (fileName.delta) with the states
+//that changed since the base. Once the delta gets bigger than compactionRatio times the base, the base is written again
+//(compacted) and the delta is removed.
+//Every file is first written to a .tmp file and then moved over the old one, so a killed process never leaves half a file.
+//A delta only applies to the base with its checkpoint number, so a delta that outlived its base is ignored.
+class PolicyCheckpointer final
+{
+public:
+	static const uint32_t deltaMagic{ 0x44505143 }; //"CQPD"
+	static const uint32_t deltaVersion{ 1 };
+
+	struct DeltaHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t checkpoint; //checkpoint number of the base
+		uint32_t actionCount;
+		uint32_t stateCount; //amount of DeltaStates that follow
+	};
+
+	//followed by actionCount floats
+	struct DeltaState
+	{
+		uint32_t rank;
+	};
+
+	explicit PolicyCheckpointer(const std::string& fileName, float compactionRatio = 0.25f)
+		: m_FileName{ fileName }
+		, m_CompactionRatio{ compactionRatio }
+		, m_Checkpoint{ static_cast<uint32_t>(std::chrono::steady_clock::now().time_since_epoch().count()) }
+	{
+		m_Thread = std::thread(&PolicyCheckpointer::Run, this);
+	}
+
+	//writes the checkpoint that is still waiting before returning
+	~PolicyCheckpointer()
+	{
+		Stop();
+	}
+
+	PolicyCheckpointer(const PolicyCheckpointer& other) = delete;
+	PolicyCheckpointer& operator=(const PolicyCheckpointer& other) = delete;
+
+	//copies the state_count * action_count values of pValues and hands them to the writing thread,
+	//a checkpoint that is still waiting is replaced
+	//when compact is true a full base is written, e.g., at the end of training so the file can be mapped by UseAgent
+	void Save(const float* pValues, bool compact = false)
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+
+		m_Waiting.assign(pValues, pValues + valueCount);
+		m_IsWaiting = true;
+		m_IsCompactWaiting = m_IsCompactWaiting || compact;
+
+		m_CheckpointAdded.notify_all();
+	}
+
+	//writes the checkpoint that is still waiting and stops the writing thread, Save can not be called afterwards
+	void Stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock{ m_Mutex };
+			m_IsStopping = true;
+		}
+
+		m_CheckpointAdded.notify_all();
+
+		if (m_Thread.joinable())
+			m_Thread.join();
+	}
+
+	//true when writing one of the checkpoints failed, call Stop first to include the last checkpoint
+	bool GetHasFailed() const { return m_HasFailed; }
+
+	//calls function(rank, pValues) for every state in the delta of fileName, if it belongs to the base with that checkpoint number
+	template<class function>
+	static bool ForEachDeltaState(const std::string& fileName, uint32_t checkpoint, function f)
+	{
+		std::ifstream file{ fileName + ".delta", std::ios::binary };
+
+		DeltaHeader header{};
+		if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+			return false;
+
+		if (header.magic != deltaMagic || header.version != deltaVersion || header.checkpoint != checkpoint || header.actionCount != CubeIndexer::action_count)
+			return false;
+
+		DeltaState state{};
+		float values[CubeIndexer::action_count]{};
+
+		for (uint32_t index{}; index < header.stateCount; ++index)
+		{
+			if (!file.read(reinterpret_cast<char*>(&state), sizeof(state)) || !file.read(reinterpret_cast<char*>(values), sizeof(values)) || state.rank >= CubeIndexer::state_count)
+				return false;
+
+			f(state.rank, static_cast<const float*>(values));
+		}
+
+		return true;
+	}
+
+private:
+	static const size_t valueCount{ CubeIndexer::state_count * CubeIndexer::action_count };
+
+	std::string m_FileName{};
+	float m_CompactionRatio{};
+
+	//values of the base file, empty until the first checkpoint is written
+	std::vector<float> m_Base{};
+	uint32_t m_Checkpoint{};
+
+	std::mutex m_Mutex{};
+	std::condition_variable m_CheckpointAdded{};
+	std::vector<float> m_Waiting{};
+	bool m_IsWaiting{};
+	bool m_IsCompactWaiting{};
+	bool m_IsStopping{};
+	std::atomic<bool> m_HasFailed{};
+
+	std::thread m_Thread{};
+
+	void Run()
+	{
+		std::vector<float> values{};
+		std::vector<char> delta{};
+
+		while (true)
+		{
+			bool compact{};
+
+			{
+				std::unique_lock<std::mutex> lock{ m_Mutex };
+
+				m_CheckpointAdded.wait(lock, [this]() { return m_IsWaiting || m_IsStopping; });
+
+				if (!m_IsWaiting)
+					return;
+
+				values.swap(m_Waiting);
+				compact = m_IsCompactWaiting;
+				m_IsWaiting = false;
+				m_IsCompactWaiting = false;
+			}
+
+			if (!compact && !m_Base.empty())
+			{
+				CreateDelta(values, delta);
+
+				//the delta is small enough, otherwise a new base is written
+				if (delta.size() <= m_CompactionRatio * valueCount * sizeof(float))
+				{
+					if (!WriteFile(m_FileName + ".delta", delta))
+						m_HasFailed = true;
+					continue;
+				}
+			}
+
+			if (!WriteBase(values))
+				m_HasFailed = true;
+		}
+	}
+
+	void CreateDelta(const std::vector<float>& values, std::vector<char>& delta) const
+	{
+		const size_t stateSize{ CubeIndexer::action_count * sizeof(float) };
+
+		DeltaHeader header{ deltaMagic, deltaVersion, m_Checkpoint, static_cast<uint32_t>(CubeIndexer::action_count), 0 };
+		delta.resize(sizeof(header));
+
+		for (size_t rank{}; rank < CubeIndexer::state_count; ++rank)
+		{
+			const float* pValues{ values.data() + rank * CubeIndexer::action_count };
+
+			if (std::memcmp(pValues, m_Base.data() + rank * CubeIndexer::action_count, stateSize) == 0)
+				continue;
+
+			const DeltaState state{ static_cast<uint32_t>(rank) };
+			delta.insert(delta.end(), reinterpret_cast<const char*>(&state), reinterpret_cast<const char*>(&state) + sizeof(state));
+			delta.insert(delta.end(), reinterpret_cast<const char*>(pValues), reinterpret_cast<const char*>(pValues) + stateSize);
+			++header.stateCount;
+		}
+
+		std::memcpy(delta.data(), &header, sizeof(header));
+	}
+
+	bool WriteBase(const std::vector<float>& values)
+	{
+		//a new number, so the old delta no longer applies even if removing it fails
+		++m_Checkpoint;
+
+		const std::string temporaryFileName{ m_FileName + ".tmp" };
+
+		if (!PolicyFile::Write(values.data(), temporaryFileName, m_Checkpoint) || !MoveOver(temporaryFileName, m_FileName))
+			return false;
+
+		m_Base = values;
+		std::remove((m_FileName + ".delta").c_str());
+
+		return true;
+	}
+
+	static bool WriteFile(const std::string& fileName, const std::vector<char>& data)
+	{
+		const std::string temporaryFileName{ fileName + ".tmp" };
+
+		{
+			std::ofstream file{ temporaryFileName, std::ios::binary | std::ios::trunc };
+
+			if (!file.is_open())
+				return false;
+
+			file.write(data.data(), static_cast<std::streamsize>(data.size()));
+			file.flush();
+
+			if (!file.good())
+				return false;
+		}
+
+		return MoveOver(temporaryFileName, fileName);
+	}
+
+	static bool MoveOver(const std::string& from, const std::string& to)
+	{
+#ifdef _WIN32
+		return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+		return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+	}
+};
+#endif // POLICYCHECKPOINTER_HPP
\ No newline at end of file
@@ -0,0 +1,206 @@
+#ifndef POLICYFILE_HPP
+#define POLICYFILE_HPP
+#include "CubeIndexer.hpp"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//PolicyFile is the binary policy format: a Header followed by the float Q-values of every state and action,
+//indexed like CubeIndexer ([rank * actionCount + actionIndex], native byte order).
+//Actions that were never learned hold the lowest float, like in relearn::dense_storage.
+//The file is memory mapped instead of parsed, so GetValues can be used by relearn::dense_view_storage
+//without copying anything.
+class PolicyFile final
+{
+public:
+	static const uint32_t magic{ 0x4C505143 }; //"CQPL"
+	static const uint32_t version{ 1 };
+
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t stateCount;
+		uint32_t actionCount;
+		uint32_t valueSize; //bytes per Q-value, only 4 (float) is written for now
+		uint32_t checkpoint; //number of the checkpoint, see PolicyCheckpointer
+	};
+
+	//maps fileName, throws std::runtime_error if it can not be mapped or is not a policy of this cube model
+	explicit PolicyFile(const std::string& fileName)
+	{
+		Map(fileName);
+
+		try
+		{
+			Validate();
+		}
+		catch (...)
+		{
+			Unmap();
+			throw;
+		}
+	}
+
+	~PolicyFile()
+	{
+		Unmap();
+	}
+
+	PolicyFile(const PolicyFile&) = delete;
+	PolicyFile& operator=(const PolicyFile&) = delete;
+
+	const float* GetValues() const
+	{
+		return reinterpret_cast<const float*>(m_pData + sizeof(Header));
+	}
+
+	uint32_t GetCheckpoint() const
+	{
+		Header header{};
+		std::memcpy(&header, m_pData, sizeof(header));
+		return header.checkpoint;
+	}
+
+	//writes the Q-values of every state of policies, policy_class is any relearn::policy of State and Action
+	template<class policy_class>
+	static bool Write(const policy_class& policies, const std::string& fileName)
+	{
+		std::vector<float> values(CubeIndexer::state_count * CubeIndexer::action_count, std::numeric_limits<float>::lowest());
+
+		for (size_t rank{}; rank < CubeIndexer::state_count; ++rank)
+		{
+			for (const auto& action : policies.actions(CubeIndexer::state_at(rank)))
+				values[rank * CubeIndexer::action_count + CubeIndexer::action_index(action.first)] = static_cast<float>(action.second);
+		}
+
+		return Write(values.data(), fileName, 0);
+	}
+
+	//writes state_count * action_count values laid out like GetValues
+	static bool Write(const float* pValues, const std::string& fileName, uint32_t checkpoint)
+	{
+		const Header header{ magic, version, static_cast<uint32_t>(CubeIndexer::state_count),
+			static_cast<uint32_t>(CubeIndexer::action_count), static_cast<uint32_t>(sizeof(float)), checkpoint };
+
+		std::ofstream file{ fileName, std::ios::binary | std::ios::trunc };
+
+		if (!file.is_open())
+			return false;
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(pValues), static_cast<std::streamsize>(CubeIndexer::state_count * CubeIndexer::action_count * sizeof(float)));
+		file.flush();
+
+		return file.good();
+	}
+
+private:
+	const char* m_pData{};
+	size_t m_Size{};
+#ifdef _WIN32
+	HANDLE m_File{ INVALID_HANDLE_VALUE };
+	HANDLE m_Mapping{};
+#endif
+
+	void Map(const std::string& fileName)
+	{
+#ifdef _WIN32
+		m_File = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		LARGE_INTEGER size{};
+		if (m_File == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_File, &size))
+		{
+			Unmap();
+			throw std::runtime_error("Could not open " + fileName);
+		}
+
+		m_Size = static_cast<size_t>(size.QuadPart);
+		m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		m_pData = m_Mapping ? static_cast<const char*>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+
+		if (!m_pData)
+		{
+			Unmap();
+			throw std::runtime_error("Could not map " + fileName);
+		}
+#else
+		const int file{ open(fileName.c_str(), O_RDONLY) };
+
+		struct stat status{};
+		if (file < 0 || fstat(file, &status) != 0)
+		{
+			if (file >= 0)
+				close(file);
+			throw std::runtime_error("Could not open " + fileName);
+		}
+
+		m_Size = static_cast<size_t>(status.st_size);
+		void* pData{ m_Size > 0 ? mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, file, 0) : MAP_FAILED };
+
+		//the mapping stays valid after closing the file
+		close(file);
+
+		if (pData == MAP_FAILED)
+			throw std::runtime_error("Could not map " + fileName);
+
+		m_pData = static_cast<const char*>(pData);
+#endif
+	}
+
+	void Unmap()
+	{
+#ifdef _WIN32
+		if (m_pData)
+			UnmapViewOfFile(m_pData);
+		if (m_Mapping)
+			CloseHandle(m_Mapping);
+		if (m_File != INVALID_HANDLE_VALUE)
+			CloseHandle(m_File);
+		m_Mapping = nullptr;
+		m_File = INVALID_HANDLE_VALUE;
+#else
+		if (m_pData)
+			munmap(const_cast<char*>(m_pData), m_Size);
+#endif
+		m_pData = nullptr;
+	}
+
+	void Validate() const
+	{
+		Header header{};
+
+		if (m_Size < sizeof(header))
+			throw std::runtime_error("Policy file is too small");
+
+		std::memcpy(&header, m_pData, sizeof(header));
+
+		if (header.magic != magic)
+			throw std::runtime_error("Not a policy file");
+
+		if (header.version != version)
+			throw std::runtime_error("Unsupported policy file version " + std::to_string(header.version));
+
+		if (header.stateCount != CubeIndexer::state_count || header.actionCount != CubeIndexer::action_count || header.valueSize != sizeof(float))
+			throw std::runtime_error("Policy file is of another cube model");
+
+		if (m_Size != sizeof(header) + size_t{ header.stateCount } * header.actionCount * header.valueSize)
+			throw std::runtime_error("Policy file is truncated");
+	}
+};
+#endif // POLICYFILE_HPP
\ No newline at end of file
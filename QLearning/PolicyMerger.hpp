@@ -0,0 +1,146 @@
+#ifndef POLICYMERGER_HPP
+#define POLICYMERGER_HPP
+#include "PolicyFile.hpp"
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+//PolicyMerger combines the policy files of training shards, processes that each trained an agent with their own seed,
+//into one policy file. Every value of the result only depends on the values of the same state and action in the shards,
+//so the states are split in ranges which are merged by their own thread.
+//Shards can also train on other machines, only their files are needed. The visits of a shard (how often each state and
+//action was learned) are kept in fileName.visits next to its policy file and are only needed by VisitWeightedMean.
+struct PolicyMerger
+{
+	static const uint32_t visitsMagic{ 0x56505143 }; //"CQPV"
+	static const uint32_t visitsVersion{ 1 };
+
+	//followed by stateCount * actionCount uint32_t visits, indexed like PolicyFile::GetValues
+	struct VisitsHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t stateCount;
+		uint32_t actionCount;
+	};
+
+	//how the values of a state and action are combined, shards that never learned it are skipped
+	enum class Rule
+	{
+		Max, //the highest value
+		VisitWeightedMean, //the mean weighted by the visits of every shard, a plain mean when none were counted
+		LastWriter //the value of the last shard, like relearn::policy::operator+=
+	};
+
+	//merges the policy files fileNames into outputFileName, throws std::runtime_error if a file can not be read
+	static bool Merge(const std::vector<std::string>& fileNames, const std::string& outputFileName, Rule rule, unsigned int amountOfThreads)
+	{
+		std::vector<std::unique_ptr<PolicyFile>> policyFiles{};
+		std::vector<std::vector<uint32_t>> visits(fileNames.size());
+
+		for (size_t shard{}; shard < fileNames.size(); ++shard)
+		{
+			policyFiles.push_back(std::make_unique<PolicyFile>(fileNames[shard]));
+
+			if (rule == Rule::VisitWeightedMean && !ReadVisits(fileNames[shard] + ".visits", visits[shard]))
+				throw std::runtime_error("Could not read the visits of " + fileNames[shard]);
+		}
+
+		std::vector<float> merged(CubeIndexer::state_count * CubeIndexer::action_count);
+
+		const size_t amountOfStates{ CubeIndexer::state_count };
+		const size_t amountOfStatesPerThread{ (amountOfStates + amountOfThreads - 1) / amountOfThreads };
+
+		auto merge = [&](size_t firstRank, size_t lastRank)
+		{
+			for (size_t valueNr{ firstRank * CubeIndexer::action_count }; valueNr < lastRank * CubeIndexer::action_count; ++valueNr)
+				merged[valueNr] = MergeValue(policyFiles, visits, valueNr, rule);
+		};
+
+		std::vector<std::thread> workers{};
+		for (size_t firstRank{ amountOfStatesPerThread }; firstRank < amountOfStates; firstRank += amountOfStatesPerThread)
+			workers.emplace_back(merge, firstRank, std::min(firstRank + amountOfStatesPerThread, amountOfStates));
+
+		merge(0, std::min(amountOfStatesPerThread, amountOfStates));
+
+		for (std::thread& worker : workers)
+			worker.join();
+
+		return PolicyFile::Write(merged.data(), outputFileName, 0);
+	}
+
+	//writes state_count * action_count visits laid out like PolicyFile::GetValues
+	static bool WriteVisits(const uint32_t* pVisits, const std::string& fileName)
+	{
+		const VisitsHeader header{ visitsMagic, visitsVersion, static_cast<uint32_t>(CubeIndexer::state_count), static_cast<uint32_t>(CubeIndexer::action_count) };
+
+		std::ofstream file{ fileName, std::ios::binary | std::ios::trunc };
+
+		if (!file.is_open())
+			return false;
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(pVisits), static_cast<std::streamsize>(CubeIndexer::state_count * CubeIndexer::action_count * sizeof(uint32_t)));
+		file.flush();
+
+		return file.good();
+	}
+
+	static bool ReadVisits(const std::string& fileName, std::vector<uint32_t>& visits)
+	{
+		std::ifstream file{ fileName, std::ios::binary };
+
+		VisitsHeader header{};
+		if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+			return false;
+
+		if (header.magic != visitsMagic || header.version != visitsVersion || header.stateCount != CubeIndexer::state_count || header.actionCount != CubeIndexer::action_count)
+			return false;
+
+		visits.resize(CubeIndexer::state_count * CubeIndexer::action_count);
+
+		return static_cast<bool>(file.read(reinterpret_cast<char*>(visits.data()), static_cast<std::streamsize>(visits.size() * sizeof(uint32_t))));
+	}
+
+private:
+	static float MergeValue(const std::vector<std::unique_ptr<PolicyFile>>& policyFiles, const std::vector<std::vector<uint32_t>>& visits, size_t valueNr, Rule rule)
+	{
+		const float unvisited{ std::numeric_limits<float>::lowest() };
+
+		float merged{ unvisited };
+		double weightedSum{};
+		double sum{};
+		double amountOfVisits{};
+		int amountOfShards{};
+
+		for (size_t shard{}; shard < policyFiles.size(); ++shard)
+		{
+			const float value{ policyFiles[shard]->GetValues()[valueNr] };
+
+			if (value == unvisited)
+				continue;
+
+			switch (rule)
+			{
+			case Rule::Max:
+				merged = std::max(merged, value);
+				break;
+			case Rule::VisitWeightedMean:
+				weightedSum += static_cast<double>(value) * visits[shard][valueNr];
+				amountOfVisits += visits[shard][valueNr];
+				sum += value;
+				++amountOfShards;
+				break;
+			case Rule::LastWriter:
+				merged = value;
+				break;
+			}
+		}
+
+		if (rule == Rule::VisitWeightedMean && amountOfShards > 0)
+			merged = static_cast<float>(amountOfVisits > 0 ? weightedSum / amountOfVisits : sum / amountOfShards);
+
+		return merged;
+	}
+};
+#endif // POLICYMERGER_HPP
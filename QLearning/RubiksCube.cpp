@@ -1,44 +1,121 @@
 #include "RubiksCube.hpp"
+#include "CubeIndexer.hpp"
+#include "PolicyFile.hpp"
+#include "PolicyCheckpointer.hpp"
+#include "PolicyMerger.hpp"
+#include "ValueIteration.hpp"
+#include "BoundedQueue.hpp"
+#include "StateSampler.hpp"
+#include "SolutionOptimizer.hpp"
+#include "TrainingMetrics.hpp"
+#include "Training.hpp"
 #include <iostream>
 #include <vector>
 #include <random>
-#include <deque>
 #include <fstream>
-#include <boost/archive/text_oarchive.hpp> // For saving
-#include <boost/archive/text_iarchive.hpp> // For loading
+#include <boost/archive/text_iarchive.hpp> // For converting text archives
 #include <conio.h> // For _getch() function
 #include <chrono>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <algorithm>
+#include <limits>
+#include <memory>
+
+void SaveAgent(const Policy& policies)
+{
+    std::cout << "Saving agent to agent.bin\n";
 
-//statics
-std::unique_ptr<CubeState> CubeState::solvedState;
-bool CubeState::isCreatingSolvedState;
+    if (!PolicyFile::Write(policies, "agent.bin"))
+    {
+        std::cout << "Could not save agent to agent.bin\n";
+        return;
+    }
 
-// create aliases for state and action:
-using State = relearn::state<CubeState>;
-using Action = relearn::action<CubeAction>;
+    std::cout << "Agent saved to agent.bin\n";
+}
 
-void SaveAgent(const relearn::policy<State, Action>& policies)
+// Converts a text archive written by the previous versions of SaveAgent (agent.policy) to agent.bin
+void ConvertTextAgent()
 {
-    std::cout << "Saving agent to agent.policy\n";
+    std::cout << "Converting agent.policy to agent.bin\n";
+
+    // The previous versions saved the nested maps of relearn::policy
+    relearn::policy<State, Action> policies{};
+
+    try
+    {
+        std::ifstream ifs("agent.policy");
+        boost::archive::text_iarchive ia(ifs);
+        ia >> policies;
+    }
+    catch (const std::exception& error)
+    {
+        std::cout << "Could not read agent.policy: " << error.what() << '\n';
+        return;
+    }
 
-    std::ofstream ofs("agent.policy");
-    boost::archive::text_oarchive oa(ofs);
-    oa << policies;
+    if (!PolicyFile::Write(policies, "agent.bin"))
+    {
+        std::cout << "Could not save agent to agent.bin\n";
+        return;
+    }
 
-    std::cout << "Agent saved to agent.policy\n";
+    std::cout << "Agent saved to agent.bin\n";
 }
 
-relearn::policy<State, Action> LoadAgent()
+// An agent of the previous versions only has agent.policy, it is converted the first time the agent is loaded
+void ConvertTextAgentIfNeeded()
 {
-    std::cout << "Loading agent from agent.policy\n";
+    if (std::ifstream{ "agent.bin" } || !std::ifstream{ "agent.policy" })
+        return;
 
-    relearn::policy<State, Action> policies{};
+    ConvertTextAgent();
+}
+
+// Copies the mapped values into a Policy that can be trained further, UseAgent uses the mapping directly
+// A new agent is returned when agent.bin can not be loaded
+Policy LoadAgent()
+{
+    ConvertTextAgentIfNeeded();
 
-    std::ifstream ifs("agent.policy");
-    boost::archive::text_iarchive ia(ifs);
-    ia >> policies;
+    std::cout << "Loading agent from agent.bin\n";
 
-    std::cout << "Successfully loaded agent from agent.policy\n";
+    Policy policies{};
+
+    try
+    {
+        PolicyFile policyFile{ "agent.bin" };
+        const MappedPolicy mappedPolicies{ MappedPolicy::storage_type(policyFile.GetValues()) };
+
+        for (size_t rank{}; rank < CubeIndexer::state_count; ++rank)
+        {
+            const State state{ CubeIndexer::state_at(rank) };
+
+            for (const auto& action : mappedPolicies.actions(state))
+                policies.update(state, action.first, action.second);
+        }
+
+        // States that changed after the last full checkpoint of TrainAgent
+        PolicyCheckpointer::ForEachDeltaState("agent.bin", policyFile.GetCheckpoint(), [&policies](uint32_t rank, const float* pValues)
+        {
+            const State state{ CubeIndexer::state_at(rank) };
+
+            for (size_t actionIndex{}; actionIndex < CubeIndexer::action_count; ++actionIndex)
+            {
+                if (pValues[actionIndex] != Policy::storage_type::unvisited())
+                    policies.update(state, CubeIndexer::action_at(actionIndex), pValues[actionIndex]);
+            }
+        });
+    }
+    catch (const std::runtime_error& error)
+    {
+        std::cout << error.what() << ", starting with a new agent\n";
+        return Policy{};
+    }
+
+    std::cout << "Successfully loaded agent from agent.bin\n";
 
     return policies;
 }
@@ -46,114 +123,450 @@ relearn::policy<State, Action> LoadAgent()
 void TrainAgent(bool trainNewAgent) //when true then the previous trained agent will be overridden
 {
     //store policies and episodes
-    relearn::policy<State, Action> policies;
+    ConcurrentPolicy policies;
 
     if (!trainNewAgent)
-        policies = LoadAgent();
+        policies = ConcurrentPolicy{ ConcurrentPolicy::storage_type(LoadAgent().storage().data()) };
 
-    std::mt19937 generator
-    (
+    // Print the seed, so the same episodes can be explored again with any amount of threads
+    const unsigned int seed
+    {
         static_cast<unsigned int>
         (
             std::chrono::high_resolution_clock::now().time_since_epoch().count()
         )
-    );
-
-    std::vector<std::deque<relearn::link<State, Action>>> episodes{};
+    };
 
     // Number of episodes to generate
     int amountOfEpisodes{ 500'000 };
 
     int maxAmountOfMovesPerEpisode{ 100 };
-    
-    int amountOfMovesInCurrentEpisode{};
 
-    std::cout << "Starting exploration\n";
+    const unsigned int amountOfThreads{ std::max(1u, std::thread::hardware_concurrency()) };
+
+    std::cout << "Starting exploration with seed " << seed << " on " << amountOfThreads << " threads\n";
+
+    // The progress is written to training.csv every second instead of to the console
+    TrainingMetrics metrics{ "training.csv" };
+    SetPolicyStatistics(policies, metrics);
 
     auto startTime = std::chrono::high_resolution_clock::now();
 
-    //Start the exploration phase
-    for (int episodeNr{ 0 }; episodeNr < amountOfEpisodes; ++episodeNr)
+    std::vector<EpisodeBatch> batches{ ExploreEpisodes(amountOfEpisodes, maxAmountOfMovesPerEpisode, seed, amountOfThreads, &metrics) };
+
+    size_t episodeMemory{};
+    for (const EpisodeBatch& batch : batches)
+        episodeMemory += batch.memory();
+
+    std::cout << "Episodes use " << episodeMemory / 1024 << "KB\n";
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    auto explorationTime{ std::chrono::duration_cast<std::chrono::duration<double>>((endTime - startTime)).count() };
+
+    std::cout << "Time taken for exploration: " << explorationTime << '\n';
+
+    // Q-learning parameters
+    double learningRate = 0.9; // Learning rate (alpha)
+    double discountRate = 0.9; // Discount rate (gamma)
+    double traceDecay = 0.0; // Weight of the longer returns (lambda)
+
+    // Create a Q-learning agent, it walks the episodes backwards so a reward reaches the start of an episode in one loop
+    relearn::q_lambda<State, Action> learner{ learningRate, discountRate, traceDecay };
+
+    // On the explored episodes the values are within 0.01 of converged after 4 loops, 10 leave a margin for other episodes
+    int amountOfTrainLoops{ 10 };
+
+    // Saves the agent on another thread, only the states that changed are written until a full save is needed
+    PolicyCheckpointer checkpointer{ "agent.bin" };
+
+    // The checkpointer needs the values in one array, the threads are not learning while they are copied
+    std::vector<float> values(CubeIndexer::state_count * CubeIndexer::action_count);
+
+    std::cout << "Start training the agent with the exploration data on " << amountOfThreads << " threads\n";
+
+    startTime = std::chrono::high_resolution_clock::now();
+
+    // Train the agent on the collected episodes
+    for (int index = 0; index < amountOfTrainLoops; ++index)
     {
-        std::cout << "episode: " << episodeNr << '\n';
+        std::cout << "Train loop " << index << " started\n";
 
-        amountOfMovesInCurrentEpisode = 0;
+        LearnBatches(batches, learner, policies, amountOfThreads);
 
-        // Create a starting state for the episode with scrambling
-        CubeState current{ true, generator };
-        State stateNow{ State(current) };
-        
-        CubeState next{ current };
+        //save the agent after each loop to be safe
+        policies.storage().copy(values.data());
+        checkpointer.Save(values.data());
+
+        SetPolicyStatistics(policies, metrics);
+        metrics.Report();
+    }
 
-        // Create a new episode (relearn::markov_chain)
-        std::deque<relearn::link<State, Action>> episode;
+    endTime = std::chrono::high_resolution_clock::now();
+
+    std::cout << "Time taken for training: " << explorationTime + std::chrono::duration_cast<std::chrono::duration<double>>((endTime - startTime)).count() << '\n';
 
-        bool stop = false;
+    // A full save, so UseAgent can map it
+    checkpointer.Save(values.data(), true);
+    checkpointer.Stop();
 
-        // Explore while Reward is zero
-        // and keep populating the episode with states and actions
-        while (!current.IsSolved() && !stop && amountOfMovesInCurrentEpisode < maxAmountOfMovesPerEpisode)
-        {
-            ++amountOfMovesInCurrentEpisode;
+    if (checkpointer.GetHasFailed())
+    {
+        std::cout << "Could not save agent to agent.bin\n";
+        return;
+    }
+
+    std::cout << "Agent saved to agent.bin\n";
+}
+
+// Like TrainAgent, but the episodes are first counted into a table of unique transitions, which the learner sweeps with
+// one update per state and action. ExploreEpisode tries every action from the same state until one is rewarded, so the
+// episodes repeat the same transitions many times and a sweep is much cheaper than a loop over the episodes. A sweep moves
+// a reward back one step, so it needs more sweeps than TrainAgent needs loops.
+void TrainAgentFromTransitions(bool trainNewAgent) //when true then the previous trained agent will be overridden
+{
+    Policy policies;
+
+    if (!trainNewAgent)
+        policies = LoadAgent();
 
-            // Randomly pick an action
-            CubeAction action = CubeAction(generator);
+    const unsigned int seed
+    {
+        static_cast<unsigned int>
+        (
+            std::chrono::high_resolution_clock::now().time_since_epoch().count()
+        )
+    };
 
-            next.DoAction(action);
+    int amountOfEpisodes{ 500'000 };
 
-            // Create the action using CubeAction as trait
-            Action actionNow = Action(action);
+    int maxAmountOfMovesPerEpisode{ 100 };
 
-            // Add the state to the episode
-            episode.emplace_back(relearn::link<State, Action>{stateNow, actionNow});
+    const unsigned int amountOfThreads{ std::max(1u, std::thread::hardware_concurrency()) };
 
-            // update current state to next state if the reward was not zero
-            if (next.reward != 0)
-            {
-                stateNow = State(next.reward, current);
-                stop = true;
-            }
-            // if the reward was zero set next back to current and try again until a non zero reward is found for current
-            else next = current;
+    std::cout << "Starting exploration with seed " << seed << " on " << amountOfThreads << " threads\n";
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    relearn::transition_table<float> transitions{};
+
+    // The batches are counted as they are explored, so the episodes are never all in memory
+    std::mutex transitionsMutex{};
+
+    ExploreChunks(amountOfEpisodes, seed, amountOfThreads, GetEpisodeFunction(maxAmountOfMovesPerEpisode), [&](int, EpisodeBatch&& batch)
+    {
+        std::lock_guard<std::mutex> lock{ transitionsMutex };
+        transitions.add(batch);
+    });
+
+    transitions.sort();
+
+    std::cout << "Counted " << transitions.samples() << " steps as " << transitions.size() << " unique transitions using "
+        << transitions.memory() / 1024 << "KB in " << std::chrono::duration_cast<std::chrono::duration<double>>((std::chrono::high_resolution_clock::now() - startTime)).count() << "s\n";
+
+    relearn::q_learning<State, Action> learner{};
+    learner.alpha = 0.9;
+    learner.gamma = 0.9;
+
+    int amountOfSweeps{ 20 };
+
+    startTime = std::chrono::high_resolution_clock::now();
+
+    for (int index = 0; index < amountOfSweeps; ++index)
+        learner(transitions, policies);
+
+    std::cout << "Time taken for " << amountOfSweeps << " sweeps: " << std::chrono::duration_cast<std::chrono::duration<double>>((std::chrono::high_resolution_clock::now() - startTime)).count() << '\n';
+
+    SaveAgent(policies);
+}
+
+// Computes the values of every state with ValueIteration instead of learning them from episodes and saves them to agent.bin,
+// LoadAgent and UseAgent read them like the values of TrainAgent
+void TrainAgentWithValueIteration()
+{
+    const float discountRate{ 0.9f };
+    const float threshold{ 1e-6f };
+    const int maxAmountOfSweeps{ 100 };
+
+    const unsigned int amountOfThreads{ std::max(1u, std::thread::hardware_concurrency()) };
+
+    std::cout << "Starting value iteration on " << amountOfThreads << " threads\n";
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    std::vector<float> values{};
+    const int amountOfSweeps{ ValueIteration::Solve(discountRate, threshold, maxAmountOfSweeps, amountOfThreads, values) };
+
+    auto iterationTime{ std::chrono::duration_cast<std::chrono::duration<double>>((std::chrono::high_resolution_clock::now() - startTime)).count() };
+
+    const MappedPolicy policies{ MappedPolicy::storage_type(values.data()) };
+
+    std::cout << "Converged in " << amountOfSweeps << " sweeps and " << iterationTime << "s, "
+        << GetPercentageOfOptimalStates(policies) << "% of the states have an optimal best action\n";
+
+    if (!PolicyFile::Write(values.data(), "agent.bin", 0))
+    {
+        std::cout << "Could not save agent to agent.bin\n";
+        return;
+    }
+
+    std::cout << "Agent saved to agent.bin\n";
+}
+
+std::string GetShardFileName(int shardNr)
+{
+    return "agent.shard" + std::to_string(shardNr) + ".bin";
+}
+
+// Trains a new agent like TrainAgent, but on one thread and with the given seed, and saves it with its visits to
+// agent.shard<shardNr>.bin. Start one process per shard, each with its own seed, and merge them with MergeShards.
+void TrainShard(int shardNr, unsigned int seed)
+{
+    ConcurrentPolicy policies;
+
+    int amountOfEpisodes{ 500'000 };
+
+    int maxAmountOfMovesPerEpisode{ 100 };
+
+    std::cout << "Training shard " << shardNr << " with seed " << seed << '\n';
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    std::vector<EpisodeBatch> batches{ ExploreEpisodes(amountOfEpisodes, maxAmountOfMovesPerEpisode, seed, 1) };
+
+    // How often every state and action is learned per loop, VisitWeightedMean weighs the values of the shards with it
+    std::vector<uint32_t> visits(CubeIndexer::state_count * CubeIndexer::action_count);
+
+    for (const EpisodeBatch& batch : batches)
+    {
+        for (size_t episodeNr{}; episodeNr < batch.size(); ++episodeNr)
+        {
+            const auto episode{ batch[episodeNr] };
+
+            for (size_t linkNr{}; linkNr < episode.size(); ++linkNr)
+                ++visits[episode[linkNr].state * CubeIndexer::action_count + episode[linkNr].action];
         }
+    }
+
+    relearn::q_lambda<State, Action> learner{ 0.9, 0.9, 0.0 };
 
-        // Store the episode in the list of experienced episodes
-        episodes.emplace_back(episode);
+    // As many loops as TrainAgent
+    int amountOfTrainLoops{ 10 };
+
+    for (int index = 0; index < amountOfTrainLoops; ++index)
+        LearnBatches(batches, learner, policies, 1);
+
+    std::vector<float> values(CubeIndexer::state_count * CubeIndexer::action_count);
+    policies.storage().copy(values.data());
+
+    const std::string fileName{ GetShardFileName(shardNr) };
+
+    if (!PolicyFile::Write(values.data(), fileName, 0) || !PolicyMerger::WriteVisits(visits.data(), fileName + ".visits"))
+    {
+        std::cout << "Could not save shard to " << fileName << '\n';
+        return;
     }
 
-    auto endTime = std::chrono::high_resolution_clock::now();
+    std::cout << "Shard saved to " << fileName << " in " << std::chrono::duration_cast<std::chrono::duration<double>>((std::chrono::high_resolution_clock::now() - startTime)).count() << "s\n";
+}
 
-    auto explorationTime{ std::chrono::duration_cast<std::chrono::duration<double>>((endTime - startTime)).count() };
+// Merges agent.shard0.bin up to agent.shard<amountOfShards - 1>.bin into agent.bin
+bool MergeShards(int amountOfShards, PolicyMerger::Rule rule)
+{
+    std::vector<std::string> fileNames{};
+    for (int shardNr{}; shardNr < amountOfShards; ++shardNr)
+        fileNames.push_back(GetShardFileName(shardNr));
 
-    std::cout << "Time taken for exploration: " << explorationTime << '\n';
+    std::cout << "Merging " << amountOfShards << " shards into agent.bin\n";
+
+    try
+    {
+        if (!PolicyMerger::Merge(fileNames, "agent.bin", rule, std::max(1u, std::thread::hardware_concurrency())))
+        {
+            std::cout << "Could not save agent to agent.bin\n";
+            return false;
+        }
+    }
+    catch (const std::runtime_error& error)
+    {
+        std::cout << error.what() << '\n';
+        return false;
+    }
+
+    std::cout << "Shards merged into agent.bin\n";
+
+    return true;
+}
+
+// Explores and learns at the same time: the explorers push their batches of episodes in a bounded queue and this thread
+// learns them as they arrive. Only the episodes in the queue are kept, so every train loop learns new episodes
+// instead of the same ones again. The order in which episodes arrive depends on the threads, so unlike the exploration
+// the learned values are not reproducible from the seed.
+void TrainAgentPipelined(bool trainNewAgent) //when true then the previous trained agent will be overridden
+{
+    Policy policies;
+
+    if (!trainNewAgent)
+        policies = LoadAgent();
+
+    const unsigned int seed
+    {
+        static_cast<unsigned int>
+        (
+            std::chrono::high_resolution_clock::now().time_since_epoch().count()
+        )
+    };
+
+    // Number of episodes to learn per train loop
+    int amountOfEpisodes{ 500'000 };
+
+    int amountOfTrainLoops{ 10 };
+
+    int maxAmountOfMovesPerEpisode{ 100 };
+
+    // This thread learns, the others explore
+    const unsigned int amountOfExplorers{ std::max(2u, std::thread::hardware_concurrency()) - 1 };
+
+    BoundedQueue<EpisodeBatch> batches{ 16 };
+
+    std::cout << "Starting pipelined training with seed " << seed << " and " << amountOfExplorers << " exploring threads\n";
+
+    // The progress is written to training.csv every second instead of to the console
+    TrainingMetrics metrics{ "training.csv" };
+    SetPolicyStatistics(policies, metrics);
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    std::thread exploration([&]()
+    {
+        ExploreChunks(amountOfEpisodes * amountOfTrainLoops, seed, amountOfExplorers, GetEpisodeFunction(maxAmountOfMovesPerEpisode), [&batches](int, EpisodeBatch&& batch)
+        {
+            batches.Push(batch);
+        }, &metrics);
+    });
 
     // Q-learning parameters
     double learningRate = 0.9; // Learning rate (alpha)
     double discountRate = 0.9; // Discount rate (gamma)
+    double traceDecay = 0.0; // Weight of the longer returns (lambda)
 
-    // Create a Q-learning agent
-    relearn::q_learning<State, Action> learner{ learningRate, discountRate };
+    relearn::q_lambda<State, Action> learner{ learningRate, discountRate, traceDecay };
 
-    std::cout << "Start training the agent with the exploration data\n";
+    PolicyCheckpointer checkpointer{ "agent.bin" };
 
-    startTime = std::chrono::high_resolution_clock::now();
+    EpisodeBatch batch{};
+    int amountOfLearnedEpisodes{};
 
-    // Train the agent on the collected episodes
-    for (int index = 0; index < 10; ++index)
+    for (int index = 0; index < amountOfTrainLoops; ++index)
     {
         std::cout << "Train loop " << index << " started\n";
-        for (auto& episode : episodes)
-            learner(episode, policies);
 
-        //save the agent after each loop to be safe
-        SaveAgent(policies);
+        // A batch can cross the end of a train loop, its episodes then count for this loop
+        while (amountOfLearnedEpisodes < (index + 1) * amountOfEpisodes)
+        {
+            batches.Pop(batch);
+
+            for (size_t episodeNr{}; episodeNr < batch.size(); ++episodeNr)
+                learner(batch[episodeNr], policies);
+
+            amountOfLearnedEpisodes += static_cast<int>(batch.size());
+        }
+
+        checkpointer.Save(policies.storage().data());
+
+        SetPolicyStatistics(policies, metrics);
+        metrics.Report();
     }
 
-    endTime = std::chrono::high_resolution_clock::now();
+    exploration.join();
 
-    std::cout << "Time taken for training: " << explorationTime + std::chrono::duration_cast<std::chrono::duration<double>>((endTime - startTime)).count() << '\n';
+    std::cout << "Time taken for exploration and training: " << std::chrono::duration_cast<std::chrono::duration<double>>((std::chrono::high_resolution_clock::now() - startTime)).count() << '\n';
 
-    SaveAgent(policies);
+    // A full save, so UseAgent can map it
+    checkpointer.Save(policies.storage().data(), true);
+    checkpointer.Stop();
+
+    if (checkpointer.GetHasFailed())
+    {
+        std::cout << "Could not save agent to agent.bin\n";
+        return;
+    }
+
+    std::cout << "Agent saved to agent.bin\n";
+}
+
+// Random actions from a scrambled cube almost never find the solved cube, so most episodes of TrainAgent have nothing to learn.
+// Curriculum training starts the episodes 1 action away from the solved cube and only starts them further away once the best actions
+// of the policy solve the states at the current distance: after every round the greedy solve rate of random states at that distance is
+// measured and once it passes solveRateThreshold the distance goes up. The training stops after the largest distance is solved.
+void TrainAgentWithCurriculum(bool trainNewAgent) //when true then the previous trained agent will be overridden
+{
+    ConcurrentPolicy policies;
+
+    if (!trainNewAgent)
+        policies = ConcurrentPolicy{ ConcurrentPolicy::storage_type(LoadAgent().storage().data()) };
+
+    const unsigned int seed
+    {
+        static_cast<unsigned int>
+        (
+            std::chrono::high_resolution_clock::now().time_since_epoch().count()
+        )
+    };
+
+    const int maxAmountOfRounds{ 500 };
+    const double solveRateThreshold{ 0.95 };
+    const int amountOfEvaluatedStates{ 1000 };
+
+    const unsigned int amountOfThreads{ std::max(1u, std::thread::hardware_concurrency()) };
+
+    relearn::q_lambda<State, Action> learner{ 0.9, 0.9, 0.0 };
+
+    // The progress is written to training.csv every second instead of to the console
+    TrainingMetrics metrics{ "training.csv" };
+
+    std::mt19937 evaluationGenerator{ seed };
+
+    std::cout << "Starting curriculum training with seed " << seed << " on " << amountOfThreads << " threads\n";
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    int distance{ 1 };
+
+    for (int round{}; round < maxAmountOfRounds; ++round)
+    {
+        LearnCurriculumRound(learner, policies, distance, seed + static_cast<unsigned int>(round), amountOfThreads, &metrics);
+
+        const double solveRate{ GetGreedySolveRate(policies, distance, amountOfEvaluatedStates, maxAmountOfCurriculumMoves, evaluationGenerator) };
+
+        SetPolicyStatistics(policies, metrics);
+        metrics.Report();
+
+        if (solveRate < solveRateThreshold)
+            continue;
+
+        std::cout << "Distance " << distance << " solved after " << round + 1 << " rounds and "
+            << std::chrono::duration_cast<std::chrono::duration<double>>((std::chrono::high_resolution_clock::now() - startTime)).count() << "s\n";
+
+        if (distance == CubeEngine::GetMaxDistance())
+            break;
+
+        ++distance;
+    }
+
+    std::cout << "Greedy solve rate of random states: " << 100.0 * GetGreedySolveRate(policies, 0, amountOfEvaluatedStates, maxAmountOfCurriculumMoves, evaluationGenerator) << "%, "
+        << GetPercentageOfOptimalStates(policies) << "% of the states have an optimal best action\n";
+
+    std::vector<float> values(CubeIndexer::state_count * CubeIndexer::action_count);
+    policies.storage().copy(values.data());
+
+    if (!PolicyFile::Write(values.data(), "agent.bin", 0))
+    {
+        std::cout << "Could not save agent to agent.bin\n";
+        return;
+    }
+
+    std::cout << "Agent saved to agent.bin\n";
 }
 
 void UseAgent()
@@ -166,14 +579,32 @@ void UseAgent()
         )
     );
 
-    relearn::policy<State, Action> policies = LoadAgent();
+    ConvertTextAgentIfNeeded();
+
+    // Map the agent instead of loading it, the values are read straight from the file
+    std::unique_ptr<PolicyFile> pPolicyFile{};
+
+    try
+    {
+        pPolicyFile.reset(new PolicyFile{ "agent.bin" });
+    }
+    catch (const std::runtime_error& error)
+    {
+        std::cout << error.what() << ", train an agent first\n";
+        return;
+    }
+
+    const MappedPolicy policies{ MappedPolicy::storage_type(pPolicyFile->GetValues()) };
 
     // Create a CubeState to represent the starting state
-    CubeState cubeToSolve{ true, generator };
+    CubeState cubeToSolve{ StateSampler::Sample(generator) };
 
     // Define the maximum number of steps to solve the cube (adjust as needed)
     int max_steps = 100;
 
+    // Actions done on the cube, shortened afterwards by the SolutionOptimizer
+    std::vector<CubeAction> solution{};
+
     // Follow the best policy to solve the cube
     for (int step = 0; step < max_steps; ++step)
     {
@@ -190,27 +621,115 @@ void UseAgent()
         // Apply the best action to the state
         if (bestAction)
         {
-            cubeToSolve.DoAction(bestAction.get()->trait().action);
+            solution.push_back(bestAction.get()->trait().action);
             std::cout << "Best action found\n";
         }
         //otherwise do a random action
         else
         {
-            cubeToSolve.DoAction(CubeAction(generator));
+            solution.push_back(CubeAction(generator));
             std::cout << "No best action found, doing random action\n";
         }
+
+        cubeToSolve.DoAction(solution.back());
     }
 
     // Check if the cube is solved after the maximum number of steps
     if (!cubeToSolve.IsSolved())
+    {
         std::cout << "Cube could not be solved within the maximum number of steps.\n";
+        return;
+    }
+
+    std::vector<CubeAction> optimizedSolution{ SolutionOptimizer::Optimize(solution) };
+
+    std::string optimizedSolutionString{};
+    for (const CubeAction& action : optimizedSolution)
+        optimizedSolutionString += cubeToSolve.ToString(action);
+
+    std::cout << "Solution of " << solution.size() << " actions optimized to " << optimizedSolution.size() << " actions: " << optimizedSolutionString << '\n';
+}
+
+void PrintUsage()
+{
+    std::cout << "Usage:\n"
+        << "  QLearning                                            trains an agent\n"
+        << "  QLearning shard <shard number> <seed>                trains a shard, see TrainShard\n"
+        << "  QLearning merge <amount of shards> <max|mean|last>   merges the shards into agent.bin, see MergeShards\n";
+}
+
+// False when text is not a whole number from 0 up to maxNumber
+bool ParseNumber(const std::string& text, unsigned long maxNumber, unsigned long& number)
+{
+    if (text.empty() || text.size() > 10 || !std::all_of(text.begin(), text.end(), [](char digit) { return digit >= '0' && digit <= '9'; }))
+        return false;
+
+    const unsigned long long value{ std::stoull(text) };
+
+    if (value > maxNumber)
+        return false;
+
+    number = static_cast<unsigned long>(value);
+
+    return true;
+}
+
+bool ParseMergeRule(const std::string& text, PolicyMerger::Rule& rule)
+{
+    if (text == "max")
+        rule = PolicyMerger::Rule::Max;
+    else if (text == "mean")
+        rule = PolicyMerger::Rule::VisitWeightedMean;
+    else if (text == "last")
+        rule = PolicyMerger::Rule::LastWriter;
+    else
+        return false;
+
+    return true;
 }
 
-int main()
+// QLearning shard <shard number> <seed>   trains a shard, see TrainShard
+// QLearning merge <amount of shards> <max|mean|last>   merges the shards into agent.bin, see MergeShards
+// Other arguments print the usage and return 1
+int main(int argc, char* argv[])
 {
+    const std::vector<std::string> arguments(argv + 1, argv + argc);
+
+    if (!arguments.empty())
+    {
+        const unsigned long maxInt{ static_cast<unsigned long>(std::numeric_limits<int>::max()) };
+        const unsigned long maxSeed{ std::numeric_limits<unsigned int>::max() };
+
+        unsigned long number{};
+        unsigned long seed{};
+        PolicyMerger::Rule rule{};
+
+        if (arguments.size() == 3 && arguments[0] == "shard" && ParseNumber(arguments[1], maxInt, number) && ParseNumber(arguments[2], maxSeed, seed))
+        {
+            TrainShard(static_cast<int>(number), static_cast<unsigned int>(seed));
+            return 0;
+        }
+
+        if (arguments.size() == 3 && arguments[0] == "merge" && ParseNumber(arguments[1], maxInt, number) && number > 0 && ParseMergeRule(arguments[2], rule))
+            return MergeShards(static_cast<int>(number), rule) ? 0 : 1;
+
+        PrintUsage();
+        return 1;
+    }
+
     TrainAgent(false);
 
+    //TrainAgentPipelined(false);
+
+    //TrainAgentFromTransitions(false);
+
+    //TrainAgentWithValueIteration();
+
+    //TrainAgentWithCurriculum(false);
+
     //UseAgent();
 
+    //ConvertTextAgent();
+
     return 0;
 }
\ No newline at end of file
@@ -5,10 +5,10 @@
 #include <vector>
 #include <random>
 #include <memory>
+#include <bitset>
 #include <boost/serialization/serialization.hpp>
 #include <boost/serialization/access.hpp>
 #include <relearn.hpp>
-#endif
 
 //this is for a 2x2x2 cube
 
@@ -131,9 +131,7 @@ struct Piece
 
 	bool operator!=(const Piece rhs) const
 	{
-		return this->side1 != rhs.side1 &&
-			this->side2 != rhs.side2 &&
-			this->side3 != rhs.side3;
+		return !(*this == rhs);
 	}
 
 	friend class boost::serialization::access;
@@ -162,32 +160,25 @@ struct Piece
 
 struct CubeState
 {
-	static std::unique_ptr<CubeState> solvedState;
-	static bool isCreatingSolvedState;
-
 	std::vector<std::shared_ptr<Piece>> pieces{};
 
 	std::vector<CubeAction> scramble; //the scramble used to get to the first state of this CubeState
 
-	double reward{};
+	//zobrist hash of the pieces: the xor of a random key for every slot and the piece in it
+	uint64_t zobristHash{};
+
+	//bit n is set when the piece in slot n is the piece of the solved cube
+	//both are kept up to date by DoAction, which only looks at the 4 slots it moves, so the reward, IsSolved and
+	//std::hash<CubeState> do not have to look at the pieces, call Recalculate after assigning pieces yourself
+	uint8_t piecesInPlace{};
 
 	CubeState()
 	{
-		if (!solvedState && !isCreatingSolvedState)
-		{
-			isCreatingSolvedState = true;
-			solvedState = std::make_unique<CubeState>();
-		}
-
 		//add all the pieces in a their correct place
-		pieces.push_back(std::make_shared<Piece>(Color::green, Color::red, Color::yellow));
-		pieces.push_back(std::make_shared<Piece>(Color::orange, Color::green, Color::yellow));
-		pieces.push_back(std::make_shared<Piece>(Color::red, Color::green, Color::white));
-		pieces.push_back(std::make_shared<Piece>(Color::green, Color::orange, Color::white));
-		pieces.push_back(std::make_shared<Piece>(Color::red, Color::blue, Color::yellow));
-		pieces.push_back(std::make_shared<Piece>(Color::blue, Color::orange, Color::yellow));
-		pieces.push_back(std::make_shared<Piece>(Color::blue, Color::red, Color::white));
-		pieces.push_back(std::make_shared<Piece>(Color::orange, Color::blue, Color::white));
+		for (int slot{}; slot < amountOfSlots; ++slot)
+			pieces.push_back(std::make_shared<Piece>(GetSolvedPiece(slot)));
+
+		Recalculate();
 	}
 
 	CubeState(bool scramble, std::mt19937& generator)
@@ -224,7 +215,7 @@ struct CubeState
 			DoAction(action);
 		}
 
-		if(pieces == solvedState->pieces)
+		if (IsSolved())
 			Scramble(generator);
 
 		//PrintScramble();
@@ -328,12 +319,12 @@ struct CubeState
 			RotateBottom(false);
 			break;
 		}
-
-		reward = CalculateReward();
 	}
 
 	void RotateRight(bool clockWise)
 	{
+		ToggleSlots(1, 3, 7, 5);
+
 		auto tempPiece = pieces[1];
 
 		if (clockWise)
@@ -351,10 +342,14 @@ struct CubeState
 			pieces[3] = pieces[1];
 			pieces[1] = tempPiece;
 		}
+
+		ToggleSlots(1, 3, 7, 5);
 	}
 
 	void RotateLeft(bool clockWise)
 	{
+		ToggleSlots(0, 4, 6, 2);
+
 		auto tempPiece = pieces[0];
 
 		if (clockWise)
@@ -372,10 +367,14 @@ struct CubeState
 			pieces[4] = pieces[0];
 			pieces[0] = tempPiece;
 		}
+
+		ToggleSlots(0, 4, 6, 2);
 	}
 
 	void RotateFront(bool clockWise)
 	{
+		ToggleSlots(0, 2, 3, 1);
+
 		auto tempPiece = pieces[0];
 
 		if (clockWise)
@@ -393,10 +392,14 @@ struct CubeState
 			pieces[2] = pieces[0];
 			pieces[0] = tempPiece;
 		}
+
+		ToggleSlots(0, 2, 3, 1);
 	}
 
 	void RotateBack(bool clockWise)
 	{
+		ToggleSlots(4, 5, 7, 6);
+
 		auto tempPiece = pieces[4];
 
 		if (clockWise)
@@ -414,10 +417,14 @@ struct CubeState
 			pieces[5] = pieces[4];
 			pieces[4] = tempPiece;
 		}
+
+		ToggleSlots(4, 5, 7, 6);
 	}
 
 	void RotateTop(bool clockWise)
 	{
+		ToggleSlots(0, 1, 5, 4);
+
 		auto tempPiece = pieces[0];
 
 		if (clockWise)
@@ -435,10 +442,14 @@ struct CubeState
 			pieces[1] = pieces[0];
 			pieces[0] = tempPiece;
 		}
+
+		ToggleSlots(0, 1, 5, 4);
 	}
 
 	void RotateBottom(bool clockWise)
 	{
+		ToggleSlots(2, 6, 7, 3);
+
 		auto tempPiece = pieces[2];
 
 		if (clockWise)
@@ -456,21 +467,58 @@ struct CubeState
 			pieces[6] = pieces[2];
 			pieces[2] = tempPiece;
 		}
+
+		ToggleSlots(2, 6, 7, 3);
 	}
 
-	bool IsSolved()
+	void Recalculate()
 	{
-		if (pieces == solvedState->pieces)
-			return true;
+		zobristHash = 0;
+		piecesInPlace = 0;
 
-		return false;
+		for (int slot{}; slot < amountOfSlots; ++slot)
+			ToggleSlot(slot);
 	}
 
-	bool operator==(const CubeState rhs) const
+	bool IsSolved() const
 	{
-		for (int index{}; index < pieces.size(); ++index)
+		return piecesInPlace == allSlots;
+	}
+
+	int GetAmountOfPiecesInPlace() const
+	{
+		return static_cast<int>(std::bitset<amountOfSlots>(piecesInPlace).count());
+	}
+
+	//slots 0, 1, 4 and 5 are the top layer
+	bool IsTopLayerComplete() const
+	{
+		return (piecesInPlace & topSlots) == topSlots;
+	}
+
+	//slots 2, 3, 6 and 7 are the bottom layer
+	bool IsBottomLayerComplete() const
+	{
+		return (piecesInPlace & bottomSlots) == bottomSlots;
+	}
+
+	//counted from piecesInPlace when it is asked for instead of after every action
+	double GetReward() const
+	{
+		//if a piece is on the correct place reward = 1
+		const double rewardForCorrectPlace{ 1 };
+
+		return GetAmountOfPiecesInPlace() * rewardForCorrectPlace;
+	}
+
+	bool operator==(const CubeState& rhs) const
+	{
+		if (zobristHash != rhs.zobristHash)
+			return false;
+
+		for (int index{}; index < amountOfSlots; ++index)
 		{
-			if (pieces[index] != rhs.pieces[index])
+			if (*pieces[index] != *rhs.pieces[index])
 				return false;
 		}
 
@@ -484,33 +532,122 @@ private:
 	{
 		for (auto& piece : pieces)
 			ar & *piece;
+
+		if (Archive::is_loading::value)
+			Recalculate();
 	}
 
-	bool AreOppositeActions(CubeAction action1, CubeAction action2)
+	//xors the key and the in place bit of the piece in the slot: done before a rotation it removes the piece,
+	//done again after the rotation it adds the piece that moved into the slot
+	void ToggleSlot(int slot)
 	{
-		if(abs(static_cast<int>(action1.action) - static_cast<int>(action2.action)) == 64
-			|| abs(log2(static_cast<int>(action1.action)) - log2(static_cast<int>(action2.action))) == 6)
-		return true;
+		const SlotKey& slotKey{ GetSlotKey(slot, *pieces[slot]) };
 
-		return false;
+		zobristHash ^= slotKey.zobristKey;
+		piecesInPlace ^= slotKey.inPlaceBit;
 	}
 
-	double CalculateReward()
+	void ToggleSlots(int slot1, int slot2, int slot3, int slot4)
 	{
-		//if a piece is on the correct place reward = 1
-		double rewardForCorrectPlace = 1;
+		ToggleSlot(slot1);
+		ToggleSlot(slot2);
+		ToggleSlot(slot3);
+		ToggleSlot(slot4);
+	}
+
+	static const Piece& GetSolvedPiece(int slot)
+	{
+		static const Piece solvedPieces[amountOfSlots]
+		{
+			{ Color::green, Color::red, Color::yellow },
+			{ Color::orange, Color::green, Color::yellow },
+			{ Color::red, Color::green, Color::white },
+			{ Color::green, Color::orange, Color::white },
+			{ Color::red, Color::blue, Color::yellow },
+			{ Color::blue, Color::orange, Color::yellow },
+			{ Color::blue, Color::red, Color::white },
+			{ Color::orange, Color::blue, Color::white }
+		};
+
+		return solvedPieces[slot];
+	}
+
+	//what a piece adds to the cube in a slot, so a slot is updated with one lookup
+	struct SlotKey
+	{
+		uint64_t zobristKey;
+		uint8_t inPlaceBit; //1 << slot for the piece of the solved cube, 0 for the others
+	};
+
+	//a key for every slot and every combination of the 3 colors of a piece
+	static const SlotKey& GetSlotKey(int slot, const Piece& piece)
+	{
+		static const std::vector<SlotKey> slotKeys{ CreateSlotKeys() };
+
+		return slotKeys[((slot * amountOfColors + ToColorIndex(piece.side1)) * amountOfColors + ToColorIndex(piece.side2)) * amountOfColors + ToColorIndex(piece.side3)];
+	}
+
+	static std::vector<SlotKey> CreateSlotKeys()
+	{
+		const Color colors[amountOfColors]{ Color::yellow, Color::white, Color::green, Color::blue, Color::orange, Color::red };
 
-		double reward{};
+		//a fixed seed so a state has the same hash in every run
+		std::mt19937_64 generator{ 0x2b2b2b };
 
-		for (int index{}; index < pieces.size(); ++index)
+		std::vector<SlotKey> slotKeys{};
+
+		for (int slot{}; slot < amountOfSlots; ++slot)
 		{
-			if (pieces[index] == solvedState->pieces[index])
+			for (Color side1 : colors)
 			{
-				reward += rewardForCorrectPlace;
+				for (Color side2 : colors)
+				{
+					for (Color side3 : colors)
+					{
+						const bool isInPlace{ Piece(side1, side2, side3) == GetSolvedPiece(slot) };
+						slotKeys.push_back({ generator(), static_cast<uint8_t>(isInPlace ? 1 << slot : 0) });
+					}
+				}
 			}
 		}
 
-		return reward;
+		return slotKeys;
+	}
+
+	static int ToColorIndex(Color color)
+	{
+		switch (color)
+		{
+		case Color::yellow:
+			return 0;
+		case Color::white:
+			return 1;
+		case Color::green:
+			return 2;
+		case Color::blue:
+			return 3;
+		case Color::orange:
+			return 4;
+		case Color::red:
+			return 5;
+		}
+
+		return 0;
+	}
+
+	static const int amountOfSlots{ 8 };
+	static const int amountOfColors{ 6 };
+	static const uint8_t allSlots{ 0xFF };
+	static const uint8_t topSlots{ 0x33 };
+	static const uint8_t bottomSlots{ 0xCC };
+
+	bool AreOppositeActions(CubeAction action1, CubeAction action2)
+	{
+		if(abs(static_cast<int>(action1.action) - static_cast<int>(action2.action)) == 64
+			|| abs(log2(static_cast<int>(action1.action)) - log2(static_cast<int>(action2.action))) == 6)
+		return true;
+
+		return false;
 	}
 };
 
@@ -520,14 +657,7 @@ namespace std
 	{
 		std::size_t operator()(CubeState const& arg) const
 		{
-			std::size_t seed = 0;
-			for (auto& piece : arg.pieces)
-			{
-				relearn::hash_combine(seed, piece->side1);
-				relearn::hash_combine(seed, piece->side2);
-				relearn::hash_combine(seed, piece->side3);
-			}
-			return seed;
+			return static_cast<std::size_t>(arg.zobristHash);
 		}
 	};
 
@@ -540,4 +670,5 @@ namespace std
 			return seed;
 		}
 	};
-}
\ No newline at end of file
+}
+#endif // RUBIKSCUBE_HPP
\ No newline at end of file
@@ -0,0 +1,162 @@
+#ifndef SOLUTIONOPTIMIZER_HPP
+#define SOLUTIONOPTIMIZER_HPP
+#include "CubeEngine.hpp"
+#include <vector>
+
+//SolutionOptimizer makes solutions shorter without changing what they do to the cube.
+//First actions on the same axis are merged or cancelled (R R' and R L R' L' disappear, R R R becomes R').
+//Then a window slides over the solution and every part of it that can be done in less actions
+//is replaced by an optimal sequence. Every state of this cube model is in the distance table of CubeEngine,
+//so the optimal sequence of a window is read from that table.
+struct SolutionOptimizer
+{
+	static const int maxWindowSize{ 14 };
+
+	static std::vector<CubeAction> Optimize(const std::vector<CubeAction>& solution)
+	{
+		std::vector<int> actionIndices{};
+		actionIndices.reserve(solution.size());
+
+		for (const CubeAction& action : solution)
+			actionIndices.push_back(CubeEngine::ToActionIndex(action));
+
+		actionIndices = Optimize(actionIndices);
+
+		std::vector<CubeAction> optimized{};
+		optimized.reserve(actionIndices.size());
+
+		for (int actionIndex : actionIndices)
+			optimized.push_back(CubeEngine::ToAction(actionIndex));
+
+		return optimized;
+	}
+
+	static std::vector<int> Optimize(std::vector<int> actionIndices)
+	{
+		actionIndices = Simplify(actionIndices);
+
+		while (ReplaceWindows(actionIndices))
+			actionIndices = Simplify(actionIndices);
+
+		return actionIndices;
+	}
+
+	static std::vector<int> Simplify(std::vector<int> actionIndices)
+	{
+		size_t previousSize{};
+
+		do
+		{
+			previousSize = actionIndices.size();
+			actionIndices = SimplifyOnce(actionIndices);
+		} while (actionIndices.size() < previousSize);
+
+		return actionIndices;
+	}
+
+private:
+	//right/left, front/back and top/bottom share an axis
+	static int GetSide(int actionIndex)
+	{
+		return actionIndex % (CubeEngine::amountOfActions / 2);
+	}
+
+	//actions on opposite sides do not influence each other (R L = L R), so every run of actions on the same axis
+	//is replaced by the net quarter turns of both its sides
+	static std::vector<int> SimplifyOnce(const std::vector<int>& actionIndices)
+	{
+		std::vector<int> simplified{};
+		simplified.reserve(actionIndices.size());
+
+		const size_t amountOfActions{ actionIndices.size() };
+		size_t index{};
+
+		while (index < amountOfActions)
+		{
+			const int axis{ GetSide(actionIndices[index]) / 2 };
+			int quarterTurns[2]{};
+
+			while (index < amountOfActions && GetSide(actionIndices[index]) / 2 == axis)
+			{
+				const int actionIndex{ actionIndices[index] };
+				quarterTurns[GetSide(actionIndex) % 2] += actionIndex < CubeEngine::amountOfActions / 2 ? 1 : 3;
+				++index;
+			}
+
+			for (int sideOfAxis{}; sideOfAxis < 2; ++sideOfAxis)
+			{
+				const int actionIndex{ axis * 2 + sideOfAxis };
+
+				switch (quarterTurns[sideOfAxis] % 4)
+				{
+				case 1:
+					simplified.push_back(actionIndex);
+					break;
+				case 2:
+					simplified.push_back(actionIndex);
+					simplified.push_back(actionIndex);
+					break;
+				case 3:
+					simplified.push_back(CubeEngine::GetInverseActionIndex(actionIndex));
+					break;
+				default:
+					break;
+				}
+			}
+		}
+
+		return simplified;
+	}
+
+	//at every start position the window that saves the most actions is replaced
+	//after a replacement the windows that overlap it are checked again
+	static bool ReplaceWindows(std::vector<int>& actionIndices)
+	{
+		bool hasReplaced{};
+		int start{};
+
+		while (start < static_cast<int>(actionIndices.size()))
+		{
+			uint32_t rank{};
+
+			int bestSaving{}, bestWindowSize{};
+			uint32_t bestRank{};
+
+			const int maxSize{ std::min(static_cast<int>(maxWindowSize), static_cast<int>(actionIndices.size()) - start) };
+
+			for (int windowSize{ 1 }; windowSize <= maxSize; ++windowSize)
+			{
+				rank = CubeEngine::DoAction(rank, actionIndices[start + windowSize - 1]);
+
+				if (windowSize - CubeEngine::GetDistance(rank) > bestSaving)
+				{
+					bestSaving = windowSize - CubeEngine::GetDistance(rank);
+					bestWindowSize = windowSize;
+					bestRank = rank;
+				}
+			}
+
+			if (bestSaving == 0)
+			{
+				++start;
+				continue;
+			}
+
+			//the inverse of an optimal solution of the window brings the solved cube to the same state as the window
+			std::vector<int> replacement{ CubeEngine::Solve(bestRank) };
+			std::reverse(replacement.begin(), replacement.end());
+
+			for (int& actionIndex : replacement)
+				actionIndex = CubeEngine::GetInverseActionIndex(actionIndex);
+
+			actionIndices.erase(actionIndices.begin() + start, actionIndices.begin() + start + bestWindowSize);
+			actionIndices.insert(actionIndices.begin() + start, replacement.begin(), replacement.end());
+
+			hasReplaced = true;
+			start = std::max(0, start - maxWindowSize + 1);
+		}
+
+		return hasReplaced;
+	}
+};
+#endif // SOLUTIONOPTIMIZER_HPP
\ No newline at end of file
@@ -0,0 +1,72 @@
+#ifndef STATESAMPLER_HPP
+#define STATESAMPLER_HPP
+#include "CubeEngine.hpp"
+#include <random>
+#include <vector>
+
+//StateSampler draws cube states uniformly by drawing a rank and unranking it,
+//instead of replaying random actions like CubeState::Scramble does.
+//A distance can be given to only draw states that need exactly that many actions to be solved.
+struct StateSampler
+{
+	//uniform over every state except the solved cube
+	static uint32_t SampleRank(std::mt19937& generator)
+	{
+		std::uniform_int_distribution<uint32_t> dist(1, CubeEngine::amountOfStates - 1);
+		return dist(generator);
+	}
+
+	//uniform over the states exactly distance actions away from the solved cube
+	//distances outside [1, CubeEngine::GetMaxDistance()] are clamped
+	static uint32_t SampleRank(int distance, std::mt19937& generator)
+	{
+		const std::vector<uint32_t>& states{ GetStatesAtDistance(distance) };
+
+		std::uniform_int_distribution<size_t> dist(0, states.size() - 1);
+		return states[dist(generator)];
+	}
+
+	static CubeState Sample(std::mt19937& generator)
+	{
+		return ToCubeState(SampleRank(generator));
+	}
+
+	static CubeState Sample(int distance, std::mt19937& generator)
+	{
+		return ToCubeState(SampleRank(distance, generator));
+	}
+
+	//the scramble of the returned CubeState is the inverse of an optimal solution
+	static CubeState ToCubeState(uint32_t rank)
+	{
+		CubeState cube{ CubeEngine::ToCubeState(CubeEngine::Unrank(rank)) };
+
+		const std::vector<int> solution{ CubeEngine::Solve(rank) };
+
+		for (auto it = solution.rbegin(); it != solution.rend(); ++it)
+			cube.scramble.push_back(CubeEngine::ToAction(CubeEngine::GetInverseActionIndex(*it)));
+
+		return cube;
+	}
+
+private:
+	static const std::vector<uint32_t>& GetStatesAtDistance(int distance)
+	{
+		static const std::vector<std::vector<uint32_t>> statesPerDistance{ CreateStatesPerDistance() };
+
+		distance = std::max(1, std::min(distance, static_cast<int>(statesPerDistance.size()) - 1));
+
+		return statesPerDistance[distance];
+	}
+
+	static std::vector<std::vector<uint32_t>> CreateStatesPerDistance()
+	{
+		std::vector<std::vector<uint32_t>> statesPerDistance(CubeEngine::GetMaxDistance() + 1);
+
+		for (uint32_t rank{}; rank < CubeEngine::amountOfStates; ++rank)
+			statesPerDistance[CubeEngine::GetDistance(rank)].push_back(rank);
+
+		return statesPerDistance;
+	}
+};
+#endif // STATESAMPLER_HPP
\ No newline at end of file
@@ -0,0 +1,285 @@
+#ifndef TRAINING_HPP
+#define TRAINING_HPP
+#include "RubiksCube.hpp"
+#include "CubeEngine.hpp"
+#include "CubeIndexer.hpp"
+#include "StateSampler.hpp"
+#include "TrainingMetrics.hpp"
+#include <relearn.hpp>
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+//Training has the aliases of the relearn classes for the cube and the exploring and learning of episodes
+//that RubiksCube.cpp trains the agent with and Benchmarks.cpp measures.
+
+//create aliases for state and action:
+using State = relearn::state<CubeState>;
+using Action = relearn::action<CubeAction>;
+//Q-values of every state in one flat array indexed by the rank of the state
+using Policy = relearn::dense_policy<State, Action, CubeIndexer>;
+//the same values, read from a memory mapped PolicyFile
+using MappedPolicy = relearn::dense_view_policy<State, Action, CubeIndexer>;
+//episodes of (rank, action index, reward) links in one buffer, see ExploreEpisode
+using EpisodeBatch = relearn::episode_batch<float>;
+//the same values as Policy, but several threads can learn them at the same time, see LearnBatches
+using ConcurrentPolicy = relearn::atomic_dense_policy<State, Action, CubeIndexer>;
+
+const int amountOfEpisodesPerChunk{ 1024 };
+
+//Adds an episode to the batch, a link only keeps the rank of the state, the index of the action and the reward of the state
+void ExploreEpisode(std::mt19937& generator, int maxAmountOfMovesPerEpisode, EpisodeBatch& batch, TrainingMetrics::Counters& counters)
+{
+	int amountOfMovesInCurrentEpisode{};
+
+	//Draw a uniformly random starting state for the episode
+	CubeState current{ StateSampler::Sample(generator) };
+	const uint32_t rankNow{ CubeEngine::Rank(current) };
+
+	CubeState next{ current };
+
+	bool stop = false;
+
+	//Explore while Reward is zero
+	//and keep populating the episode with states and actions
+	while (!current.IsSolved() && !stop && amountOfMovesInCurrentEpisode < maxAmountOfMovesPerEpisode)
+	{
+		++amountOfMovesInCurrentEpisode;
+
+		//Randomly pick an action
+		CubeAction action = CubeAction(generator);
+
+		next.DoAction(action);
+
+		//Add the state to the episode, the reward belongs to the action that found it
+		batch.push_back(rankNow, static_cast<uint8_t>(CubeEngine::ToActionIndex(action)), static_cast<float>(next.GetReward()));
+
+		//stop once a reward is found
+		if (next.GetReward() != 0)
+			stop = true;
+		//if the reward was zero set next back to current and try again until a non zero reward is found for current
+		else next = current;
+	}
+
+	batch.end_episode();
+
+	counters.AddEpisode(amountOfMovesInCurrentEpisode, next.IsSolved());
+}
+
+//ExploreEpisode as the episode function of ExploreChunks
+auto GetEpisodeFunction(int maxAmountOfMovesPerEpisode)
+{
+	return [maxAmountOfMovesPerEpisode](std::mt19937& generator, EpisodeBatch& batch, TrainingMetrics::Counters& counters)
+	{
+		ExploreEpisode(generator, maxAmountOfMovesPerEpisode, batch, counters);
+	};
+}
+
+//Adds an episode that starts distance actions away from the solved cube (any state when distance is 0) and does random actions
+//until the cube is solved or maxAmountOfMovesPerEpisode actions are done. The action that solves the cube gets a reward of 1,
+//an episode that does not reach it has no reward.
+void ExploreCurriculumEpisode(std::mt19937& generator, int distance, int maxAmountOfMovesPerEpisode, EpisodeBatch& batch, TrainingMetrics::Counters& counters)
+{
+	std::uniform_int_distribution<int> actionDistribution(0, CubeEngine::amountOfActions - 1);
+
+	const uint32_t solvedRank{ 0 };
+
+	uint32_t rank{ distance > 0 ? StateSampler::SampleRank(distance, generator) : StateSampler::SampleRank(generator) };
+	int amountOfMoves{};
+
+	while (rank != solvedRank && amountOfMoves < maxAmountOfMovesPerEpisode)
+	{
+		const int actionIndex{ actionDistribution(generator) };
+		const uint32_t previousRank{ rank };
+
+		rank = CubeEngine::DoAction(rank, actionIndex);
+		batch.push_back(previousRank, static_cast<uint8_t>(actionIndex), rank == solvedRank ? 1.0f : 0.0f);
+		++amountOfMoves;
+	}
+
+	batch.end_episode();
+
+	counters.AddEpisode(amountOfMoves, rank == solvedRank);
+}
+
+//Every episode is independent, so they are explored in chunks by a pool of threads (the calling thread is one of them)
+//and every chunk is handed to store(chunk, batch). A chunk has its own generator seeded with the seed and the chunk number,
+//so the episodes only depend on the seed, not on the amount of threads. The episodes are counted in pMetrics if it is given.
+//exploreEpisode(generator, batch, counters) adds one episode, e.g., ExploreEpisode or ExploreCurriculumEpisode.
+template<class EpisodeFunction, class StoreFunction>
+void ExploreChunks(int amountOfEpisodes, unsigned int seed, unsigned int amountOfThreads, EpisodeFunction exploreEpisode, StoreFunction store, TrainingMetrics* pMetrics = nullptr)
+{
+	std::atomic<int> nextChunk{};
+
+	auto explore = [&]()
+	{
+		TrainingMetrics::Counters counters{ pMetrics };
+
+		for (int chunk{ nextChunk++ }; chunk * amountOfEpisodesPerChunk < amountOfEpisodes; chunk = nextChunk++)
+		{
+			std::seed_seq seedSequence{ seed, static_cast<unsigned int>(chunk) };
+			std::mt19937 generator(seedSequence);
+
+			const int lastEpisodeNr{ std::min(amountOfEpisodes, (chunk + 1) * amountOfEpisodesPerChunk) };
+
+			EpisodeBatch batch{};
+
+			for (int episodeNr{ chunk * amountOfEpisodesPerChunk }; episodeNr < lastEpisodeNr; ++episodeNr)
+				exploreEpisode(generator, batch, counters);
+
+			batch.shrink_to_fit();
+
+			store(chunk, std::move(batch));
+		}
+	};
+
+	std::vector<std::thread> workers{};
+	for (unsigned int threadNr{ 1 }; threadNr < amountOfThreads; ++threadNr)
+		workers.emplace_back(explore);
+
+	explore();
+
+	for (std::thread& worker : workers)
+		worker.join();
+}
+
+//One batch per chunk, every chunk writes to its own batch so no locks are needed
+std::vector<EpisodeBatch> ExploreEpisodes(int amountOfEpisodes, int maxAmountOfMovesPerEpisode, unsigned int seed, unsigned int amountOfThreads, TrainingMetrics* pMetrics = nullptr)
+{
+	std::vector<EpisodeBatch> batches((amountOfEpisodes + amountOfEpisodesPerChunk - 1) / amountOfEpisodesPerChunk);
+
+	ExploreChunks(amountOfEpisodes, seed, amountOfThreads, GetEpisodeFunction(maxAmountOfMovesPerEpisode), [&batches](int chunk, EpisodeBatch&& batch)
+	{
+		batches[chunk] = std::move(batch);
+	}, pMetrics);
+
+	return batches;
+}
+
+//The percentage of the states whose best action brings the cube closer to solved
+template<class PolicyClass>
+double GetPercentageOfOptimalStates(const PolicyClass& policies)
+{
+	int amountOfOptimalStates{};
+
+	for (uint32_t rank{ 1 }; rank < CubeEngine::amountOfStates; ++rank)
+	{
+		const auto values{ policies.storage().values_at(rank) };
+		const size_t bestActionIndex{ relearn::argmax<CubeIndexer::action_count>(&values[0]) };
+
+		if (values[bestActionIndex] != Policy::storage_type::unvisited() && CubeEngine::GetDistance(CubeEngine::DoAction(rank, static_cast<int>(bestActionIndex))) < CubeEngine::GetDistance(rank))
+			++amountOfOptimalStates;
+	}
+
+	return 100.0 * amountOfOptimalStates / (CubeEngine::amountOfStates - 1);
+}
+
+//Hands the amount of states with a learned value and the memory of the values to the metrics,
+//only call it while no thread is learning a Policy, a ConcurrentPolicy can be read at any time
+template<class PolicyClass>
+void SetPolicyStatistics(const PolicyClass& policies, TrainingMetrics& metrics)
+{
+	size_t amountOfVisitedStates{};
+
+	for (uint32_t rank{}; rank < CubeEngine::amountOfStates; ++rank)
+	{
+		const auto values{ policies.storage().values_at(rank) };
+
+		if (values[relearn::argmax<CubeIndexer::action_count>(&values[0])] != Policy::storage_type::unvisited())
+			++amountOfVisitedStates;
+	}
+
+	metrics.SetPolicyStatistics(amountOfVisitedStates, CubeIndexer::state_count * CubeIndexer::action_count * sizeof(float));
+}
+
+//The fraction of amountOfStates random states at the distance (any state when distance is 0) that the best actions of the policy
+//solve within maxAmountOfMoves actions
+template<class PolicyClass>
+double GetGreedySolveRate(const PolicyClass& policies, int distance, int amountOfStates, int maxAmountOfMoves, std::mt19937& generator)
+{
+	const uint32_t solvedRank{ 0 };
+
+	int amountOfSolvedStates{};
+
+	for (int stateNr{}; stateNr < amountOfStates; ++stateNr)
+	{
+		uint32_t rank{ distance > 0 ? StateSampler::SampleRank(distance, generator) : StateSampler::SampleRank(generator) };
+
+		for (int move{}; move < maxAmountOfMoves && rank != solvedRank; ++move)
+		{
+			const auto values{ policies.storage().values_at(rank) };
+			const size_t bestActionIndex{ relearn::argmax<CubeIndexer::action_count>(&values[0]) };
+
+			if (values[bestActionIndex] == Policy::storage_type::unvisited())
+				break;
+
+			rank = CubeEngine::DoAction(rank, static_cast<int>(bestActionIndex));
+		}
+
+		if (rank == solvedRank)
+			++amountOfSolvedStates;
+	}
+
+	return static_cast<double>(amountOfSolvedStates) / amountOfStates;
+}
+
+//Learns every episode of the batches once on amountOfThreads threads (the calling thread is one of them), a thread takes
+//the next batch nobody took yet. The threads update the shared values without locks: an update of one thread can overwrite
+//an update of the same state and action by another one (Hogwild!), and which thread learns which batch differs per run,
+//so the learned values are not reproducible. CompareConcurrentTraining shows they converge like the serial ones.
+template<class Learner>
+void LearnBatches(const std::vector<EpisodeBatch>& batches, const Learner& learner, ConcurrentPolicy& policies, unsigned int amountOfThreads)
+{
+	std::atomic<size_t> nextBatch{};
+
+	auto learn = [&]()
+	{
+		//q_lambda only reads its parameters, but every thread gets its own to be sure
+		Learner threadLearner{ learner };
+
+		for (size_t batchNr{ nextBatch++ }; batchNr < batches.size(); batchNr = nextBatch++)
+		{
+			const EpisodeBatch& batch{ batches[batchNr] };
+
+			for (size_t episodeNr{}; episodeNr < batch.size(); ++episodeNr)
+				threadLearner(batch[episodeNr], policies);
+		}
+	};
+
+	std::vector<std::thread> workers{};
+	for (unsigned int threadNr{ 1 }; threadNr < amountOfThreads; ++threadNr)
+		workers.emplace_back(learn);
+
+	learn();
+
+	for (std::thread& worker : workers)
+		worker.join();
+}
+
+const int amountOfCurriculumEpisodesPerRound{ 20'000 };
+const int maxAmountOfCurriculumMoves{ 20 };
+
+//Explores the episodes of one round of curriculum training with ExploreCurriculumEpisode and learns them once. The episodes start
+//at a random distance from 1 up to distance, so the states closer to the solved cube are not forgotten (any state when distance is 0).
+template<class Learner>
+void LearnCurriculumRound(const Learner& learner, ConcurrentPolicy& policies, int distance, unsigned int seed, unsigned int amountOfThreads, TrainingMetrics* pMetrics)
+{
+	std::vector<EpisodeBatch> batches((amountOfCurriculumEpisodesPerRound + amountOfEpisodesPerChunk - 1) / amountOfEpisodesPerChunk);
+
+	auto exploreEpisode = [distance](std::mt19937& generator, EpisodeBatch& batch, TrainingMetrics::Counters& counters)
+	{
+		std::uniform_int_distribution<int> distanceDistribution(std::min(distance, 1), distance);
+		ExploreCurriculumEpisode(generator, distanceDistribution(generator), maxAmountOfCurriculumMoves, batch, counters);
+	};
+
+	ExploreChunks(amountOfCurriculumEpisodesPerRound, seed, amountOfThreads, exploreEpisode, [&batches](int chunk, EpisodeBatch&& batch)
+	{
+		batches[chunk] = std::move(batch);
+	}, pMetrics);
+
+	LearnBatches(batches, learner, policies, amountOfThreads);
+}
+
+#endif // TRAINING_HPP
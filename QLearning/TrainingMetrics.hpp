@@ -0,0 +1,215 @@
+#ifndef TRAININGMETRICS_HPP
+#define TRAININGMETRICS_HPP
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//TrainingMetrics writes the progress of training to a csv file on a background thread, every interval and whenever Report is called,
+//instead of writing to the console for every episode. A line has the episodes and transitions per second since the previous line,
+//the mean episode length and solve rate of all episodes so far and the distinct states and memory of the policy.
+//Every exploring thread counts its episodes in its own Counters, the hot loop only does a relaxed load and store on them,
+//the writing thread adds up the counters of all threads when it writes a line.
+//The policy is not read by the writing thread, training hands its statistics over with SetPolicyStatistics when it is safe to read it.
+class TrainingMetrics final
+{
+public:
+	//the counts of one thread, keep them on the stack of that thread (so they do not share a cache line with the others)
+	//when pMetrics is nullptr nothing is reported
+	class Counters final
+	{
+	public:
+		explicit Counters(TrainingMetrics* pMetrics)
+			: m_pMetrics{ pMetrics }
+		{
+			if (m_pMetrics)
+				m_pMetrics->Add(this);
+		}
+
+		//the counts stay part of the totals of the metrics
+		~Counters()
+		{
+			if (m_pMetrics)
+				m_pMetrics->Remove(this);
+		}
+
+		Counters(const Counters& other) = delete;
+		Counters& operator=(const Counters& other) = delete;
+
+		void AddEpisode(uint64_t amountOfTransitions, bool isSolved)
+		{
+			Increase(m_Episodes, 1);
+			Increase(m_Transitions, amountOfTransitions);
+
+			if (isSolved)
+				Increase(m_SolvedEpisodes, 1);
+		}
+
+	private:
+		friend class TrainingMetrics;
+
+		TrainingMetrics* m_pMetrics{};
+
+		std::atomic<uint64_t> m_Episodes{};
+		std::atomic<uint64_t> m_Transitions{};
+		std::atomic<uint64_t> m_SolvedEpisodes{};
+
+		//only this thread writes the counter, so it does not need a read-modify-write
+		static void Increase(std::atomic<uint64_t>& counter, uint64_t amount)
+		{
+			counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+		}
+	};
+
+	explicit TrainingMetrics(const std::string& fileName, std::chrono::milliseconds interval = std::chrono::milliseconds(1000))
+		: m_File{ fileName, std::ios::trunc }
+		, m_Interval{ interval }
+		, m_StartTime{ std::chrono::steady_clock::now() }
+		, m_LastReportTime{ m_StartTime }
+	{
+		m_File << "seconds,episodes,episodesPerSecond,transitions,transitionsPerSecond,meanEpisodeLength,solveRate,distinctStates,policyMemory\n";
+
+		m_Thread = std::thread(&TrainingMetrics::Run, this);
+	}
+
+	//writes a last line before returning
+	~TrainingMetrics()
+	{
+		{
+			std::lock_guard<std::mutex> lock{ m_Mutex };
+			m_IsStopping = true;
+		}
+
+		m_StopRequested.notify_all();
+
+		if (m_Thread.joinable())
+			m_Thread.join();
+
+		Report();
+	}
+
+	TrainingMetrics(const TrainingMetrics& other) = delete;
+	TrainingMetrics& operator=(const TrainingMetrics& other) = delete;
+
+	//the policy values the training does not write at the moment, e.g., between two train loops
+	void SetPolicyStatistics(size_t amountOfDistinctStates, size_t policyMemory)
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+
+		m_AmountOfDistinctStates = amountOfDistinctStates;
+		m_PolicyMemory = policyMemory;
+	}
+
+	//writes a line now, the next line is still written an interval after the previous one of the background thread
+	void Report()
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+
+		const Totals totals{ GetTotals() };
+		const auto now{ std::chrono::steady_clock::now() };
+
+		const double seconds{ std::chrono::duration<double>(now - m_StartTime).count() };
+		const double secondsSinceLastReport{ std::max(std::chrono::duration<double>(now - m_LastReportTime).count(), 1e-9) };
+
+		m_File << seconds << ','
+			<< totals.episodes << ','
+			<< (totals.episodes - m_LastTotals.episodes) / secondsSinceLastReport << ','
+			<< totals.transitions << ','
+			<< (totals.transitions - m_LastTotals.transitions) / secondsSinceLastReport << ','
+			<< (totals.episodes > 0 ? static_cast<double>(totals.transitions) / totals.episodes : 0.0) << ','
+			<< (totals.episodes > 0 ? static_cast<double>(totals.solvedEpisodes) / totals.episodes : 0.0) << ','
+			<< m_AmountOfDistinctStates << ','
+			<< m_PolicyMemory << '\n';
+
+		m_File.flush();
+
+		if (!m_File.good())
+			m_HasFailed = true;
+
+		m_LastTotals = totals;
+		m_LastReportTime = now;
+	}
+
+	//true when the file could not be written
+	bool GetHasFailed() const { return m_HasFailed; }
+
+private:
+	struct Totals
+	{
+		uint64_t episodes;
+		uint64_t transitions;
+		uint64_t solvedEpisodes;
+	};
+
+	std::ofstream m_File{};
+	std::chrono::milliseconds m_Interval{};
+	std::chrono::steady_clock::time_point m_StartTime{};
+	std::chrono::steady_clock::time_point m_LastReportTime{};
+
+	std::mutex m_Mutex{};
+	std::condition_variable m_StopRequested{};
+	bool m_IsStopping{};
+	std::atomic<bool> m_HasFailed{};
+
+	//the counters of the threads that are counting and the counts of the ones that stopped
+	std::vector<const Counters*> m_Counters{};
+	Totals m_Finished{};
+	Totals m_LastTotals{};
+
+	size_t m_AmountOfDistinctStates{};
+	size_t m_PolicyMemory{};
+
+	std::thread m_Thread{};
+
+	void Run()
+	{
+		std::unique_lock<std::mutex> lock{ m_Mutex };
+
+		while (!m_StopRequested.wait_for(lock, m_Interval, [this]() { return m_IsStopping; }))
+		{
+			lock.unlock();
+			Report();
+			lock.lock();
+		}
+	}
+
+	void Add(const Counters* pCounters)
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+
+		m_Counters.push_back(pCounters);
+	}
+
+	void Remove(const Counters* pCounters)
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+
+		AddCounts(*pCounters, m_Finished);
+		m_Counters.erase(std::remove(m_Counters.begin(), m_Counters.end(), pCounters), m_Counters.end());
+	}
+
+	//m_Mutex has to be locked
+	Totals GetTotals() const
+	{
+		Totals totals{ m_Finished };
+
+		for (const Counters* pCounters : m_Counters)
+			AddCounts(*pCounters, totals);
+
+		return totals;
+	}
+
+	static void AddCounts(const Counters& counters, Totals& totals)
+	{
+		totals.episodes += counters.m_Episodes.load(std::memory_order_relaxed);
+		totals.transitions += counters.m_Transitions.load(std::memory_order_relaxed);
+		totals.solvedEpisodes += counters.m_SolvedEpisodes.load(std::memory_order_relaxed);
+	}
+};
+#endif // TRAININGMETRICS_HPP
@@ -0,0 +1,86 @@
+#ifndef VALUEITERATION_HPP
+#define VALUEITERATION_HPP
+#include "CubeIndexer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+//ValueIteration computes the Q-values of every state and action without exploring: every sweep goes over all ranks and
+//sets Q(s, a) = discountRate * V(s') with s' = CubeEngine::DoAction(s, a) and V(s') = max Q(s', a') of the previous sweep.
+//The solved cube is the only state with a reward, all its actions are worth 1, so V(s) becomes discountRate ^ distance(s)
+//and a value only changes in the sweep that reaches its distance: the sweeps stop after GetMaxDistance() + 2 sweeps.
+//The sweeps are synchronous (every sweep only reads the values of the previous one), so the ranks are split in ranges
+//which are updated by their own thread without locks, and the result does not depend on the amount of threads.
+struct ValueIteration
+{
+	//fills values with state_count * action_count Q-values laid out like PolicyFile::GetValues, sweeping until no state value
+	//changes more than threshold or maxAmountOfSweeps are done, returns the amount of sweeps
+	static int Solve(float discountRate, float threshold, int maxAmountOfSweeps, unsigned int amountOfThreads, std::vector<float>& values)
+	{
+		const size_t amountOfStates{ CubeIndexer::state_count };
+		const size_t amountOfStatesPerThread{ (amountOfStates + amountOfThreads - 1) / amountOfThreads };
+
+		values.assign(amountOfStates * CubeIndexer::action_count, 0.0f);
+
+		std::vector<float> stateValues(amountOfStates);
+		std::vector<float> nextStateValues(amountOfStates);
+		std::vector<float> largestChanges(amountOfThreads);
+
+		//the move table is built the first time it is used
+		CubeEngine::DoAction(0, 0);
+
+		auto sweep = [&](unsigned int threadNr)
+		{
+			const size_t firstRank{ std::min(threadNr * amountOfStatesPerThread, amountOfStates) };
+			const size_t lastRank{ std::min(firstRank + amountOfStatesPerThread, amountOfStates) };
+
+			float largestChange{};
+
+			for (size_t rank{ firstRank }; rank < lastRank; ++rank)
+			{
+				float* pValues{ values.data() + rank * CubeIndexer::action_count };
+				float stateValue{};
+
+				for (int actionIndex{}; actionIndex < CubeEngine::amountOfActions; ++actionIndex)
+				{
+					pValues[actionIndex] = rank == solvedRank ? 1.0f
+						: discountRate * stateValues[CubeEngine::DoAction(static_cast<uint32_t>(rank), actionIndex)];
+
+					stateValue = std::max(stateValue, pValues[actionIndex]);
+				}
+
+				largestChange = std::max(largestChange, std::abs(stateValue - stateValues[rank]));
+				nextStateValues[rank] = stateValue;
+			}
+
+			largestChanges[threadNr] = largestChange;
+		};
+
+		int amountOfSweeps{};
+
+		while (amountOfSweeps < maxAmountOfSweeps)
+		{
+			std::vector<std::thread> workers{};
+			for (unsigned int threadNr{ 1 }; threadNr < amountOfThreads; ++threadNr)
+				workers.emplace_back(sweep, threadNr);
+
+			sweep(0);
+
+			for (std::thread& worker : workers)
+				worker.join();
+
+			++amountOfSweeps;
+			stateValues.swap(nextStateValues);
+
+			if (*std::max_element(largestChanges.begin(), largestChanges.end()) <= threshold)
+				break;
+		}
+
+		return amountOfSweeps;
+	}
+
+private:
+	static const size_t solvedRank{ 0 };
+};
+#endif // VALUEITERATION_HPP
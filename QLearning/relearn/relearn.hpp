@@ -16,11 +16,20 @@
  * limitations under the License.
  */
 #include <unordered_map>
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cmath>
+#include <limits>
 #include <deque>
 #include <functional>
 #include <algorithm>
+#include <iterator>
 #include <memory>
+#include <atomic>
+#include <random>
 #include <cassert>
+#include <stdexcept>
 #ifdef USING_BOOST_SERIALIZATION
 #include "serialize.tpl"
 #endif
@@ -191,6 +200,615 @@ namespace relearn
         bool operator==(const link<state_class, action_class>& arg) const;
     };
 
+    /**
+     * @struct compact_link
+     * @brief a `link` of a state index and an action index (@see `dense_storage`)
+     * @date 19-October-2026
+     * @version 0.1.0
+     *
+     * For states and actions that an `indexer` can map to indices, a link is then
+     * 8 bytes (with a float reward) instead of copies of the state and action.
+     * The state index and the action index share 4 bytes, so there are at most
+     * `max_state_count` states.
+     * The reward is the reward of the state, like `link::state.reward()`.
+     */
+    template <typename reward_type = float>
+    struct compact_link
+    {
+        static const std::uint32_t max_state_count = 1u << 24;
+
+        std::uint32_t state : 24;
+        std::uint32_t action : 8;
+        reward_type reward;
+    };
+
+    /**
+     * @struct compact_episode
+     * @brief the links of one episode in an `episode_batch`
+     */
+    template <typename reward_type = float>
+    struct compact_episode
+    {
+        const compact_link<reward_type>* first;
+        const compact_link<reward_type>* last;
+        /// @return amount of links
+        std::size_t size() const;
+        const compact_link<reward_type>& operator[](std::size_t index) const;
+    };
+
+    /**
+     * @class episode_batch
+     * @brief many episodes of `compact_link`s in one buffer
+     * @date 19-October-2026
+     * @version 0.1.0
+     *
+     * The links of all episodes are appended to one vector, so a batch allocates a few
+     * times while it grows instead of once per episode (e.g., the chunks of a `std::deque`).
+     * Add the links of an episode with `push_back` and finish it with `end_episode`.
+     */
+    template <typename reward_type = float>
+    class episode_batch
+    {
+    public:
+        /// @brief add a link to the current episode, @param s_t is below `compact_link::max_state_count`
+        void push_back(std::uint32_t s_t,
+            std::uint8_t a_t,
+            reward_type r);
+        /// @brief finish the current episode, the next `push_back` starts a new one
+        void end_episode();
+        /// @return amount of finished episodes
+        std::size_t size() const;
+        /// @return episode @param index
+        compact_episode<reward_type> operator[](std::size_t index) const;
+        /// @return bytes used by the links and episodes
+        std::size_t memory() const;
+        /// @brief free the memory reserved for more links and episodes
+        void shrink_to_fit();
+    protected:
+        std::vector<compact_link<reward_type>> __links__;
+        // end of every episode in `__links__`
+        std::vector<std::uint32_t> __ends__;
+    };
+
+    /**
+     * @struct transition
+     * @brief a step of an episode and the step after it, the unit of `prioritized_replay`
+     * @date 19-October-2026
+     * @version 0.1.0
+     *
+     * `link_class` is a `link` or a `compact_link`. The last step of an episode has no
+     * next step, it is marked with `last` (and `next` is the step itself).
+     */
+    template <class link_class>
+    struct transition
+    {
+        link_class step;
+        link_class next;
+        bool last;
+    };
+
+    /**
+     * @class sum_tree
+     * @brief a binary tree in an array where every node is the sum of its two children
+     * @date 19-October-2026
+     * @version 0.1.0
+     *
+     * The leaves hold the priorities of `capacity` items, the root their total. Setting a
+     * priority updates the sums above it and finding the item of a prefix of the total walks
+     * down from the root, both O(log n). Drawing a prefix uniformly in [0, total) then finds
+     * an item with a probability proportional to its priority.
+     */
+    template <typename value_type = double>
+    class sum_tree
+    {
+    public:
+        /// @brief a tree of @param capacity priorities which are zero
+        explicit sum_tree(std::size_t capacity);
+        /// @brief set the priority of item @param index
+        void set(std::size_t index, value_type priority);
+        /// @return the priority of item @param index
+        value_type get(std::size_t index) const;
+        /// @return the sum of all priorities
+        value_type total() const;
+        /// @return the item whose range of the total contains @param prefix in [0, total())
+        std::size_t find(value_type prefix) const;
+    protected:
+        // amount of leaves, a power of two so every leaf is as deep as the others
+        std::size_t __leaves__;
+        // [1] is the root, the children of node i are 2i and 2i + 1, item i is node `__leaves__ + i`
+        std::vector<value_type> __nodes__;
+    };
+
+    /**
+     * @class prioritized_replay
+     * @brief a fixed capacity buffer of transitions which are sampled in proportion to their TD error
+     * @date 19-October-2026
+     * @version 0.1.0
+     *
+     * Replaying every episode uniformly costs as much for a transition whose values already
+     * converged as for one that still changes them. This buffer keeps the priority
+     * `(|TD error| + epsilon)^alpha` of every transition in a `sum_tree`, so `sample` draws
+     * the transitions that move values more often. Learn a sampled transition with
+     * `q_learning` or `q_probabilistic` (they return its TD error) and put the error back with
+     * `update`. New transitions get the highest priority so far, so they are learned at least once.
+     * When the buffer is full a new transition replaces the oldest one.
+     *
+     * Template parameter `transition_class` is a `transition` of `link`s or `compact_link`s.
+     */
+    template <class transition_class,
+        typename value_type = double>
+    class prioritized_replay
+    {
+    public:
+        /**
+         * @param capacity the amount of transitions that are kept
+         * @param alpha how much the TD error counts, 0 samples uniformly
+         * @param epsilon so a transition without an error is still sampled now and then
+         */
+        explicit prioritized_replay(std::size_t capacity,
+            value_type alpha = 0.6,
+            value_type epsilon = 0.01);
+        /// @brief add @param arg with the highest priority so far
+        void push(const transition_class& arg);
+        /// @brief add every step of @param episode, a `markov_chain` or `compact_episode` of the links of `transition_class`
+        template <class episode_class>
+        void push_episode(const episode_class& episode);
+        /// @return index of a transition drawn with a probability proportional to its priority
+        template <class generator>
+        std::size_t sample(generator& g) const;
+        /// @brief put @param count indices in @param indices, one from each of `count` equal parts of the total priority
+        template <class generator>
+        void sample(std::size_t count,
+            generator& g,
+            std::vector<std::size_t>& indices) const;
+        /// @return transition @param index
+        const transition_class& operator[](std::size_t index) const;
+        /// @brief set the priority of transition @param index from its @param td_error
+        void update(std::size_t index, value_type td_error);
+        /// @brief `update` for every sampled index and its TD error
+        void update(const std::vector<std::size_t>& indices,
+            const std::vector<value_type>& td_errors);
+        /// @return amount of transitions
+        std::size_t size() const;
+        /// @return maximum amount of transitions
+        std::size_t capacity() const;
+    protected:
+        std::vector<transition_class> __transitions__;
+        sum_tree<value_type> __priorities__;
+        std::size_t __capacity__;
+        // where the next transition goes, the oldest one once the buffer is full
+        std::size_t __next__ = 0;
+        value_type __alpha__;
+        value_type __epsilon__;
+        value_type __max_priority__ = 1;
+    };
+
+    /**
+     * @struct transition_count
+     * @brief a transition of a `transition_table` and how often it was experienced
+     * @date 19-October-2026
+     * @version 0.1.0
+     */
+    template <typename reward_type = float>
+    struct transition_count
+    {
+        std::uint32_t state;
+        std::uint8_t action;
+        /// the last step of an episode, `next` is then the state itself
+        bool last;
+        std::uint32_t next;
+        reward_type reward;
+        std::uint32_t count;
+    };
+    /// @brief the same transition, the counts are not compared
+    template <typename reward_type>
+    struct equal<transition_count<reward_type>>
+    {
+        bool operator()(const transition_count<reward_type>& lhs,
+            const transition_count<reward_type>& rhs) const;
+    };
+    /// @brief hashes the transition, not the count
+    template <typename reward_type>
+    struct hasher<transition_count<reward_type>>
+    {
+        std::size_t operator()(const transition_count<reward_type>& arg) const;
+    };
+
+    /**
+     * @class transition_table
+     * @brief the unique (s, a, s', r) transitions of many episodes with their counts
+     * @date 19-October-2026
+     * @version 0.1.0
+     *
+     * Random exploration repeats the same transitions many times, within an episode and across
+     * episodes. Adding the episodes of an `episode_batch` to this table keeps every transition
+     * once with the amount of times it was seen, so `q_learning` and `q_probabilistic` can learn
+     * from the table with one update per state and action instead of one per link, and the
+     * counts are the frequencies `q_probabilistic` needs.
+     *
+     * Call `sort` after adding, it puts the transitions of a state and action next to each other
+     * for `for_each_pair`.
+     */
+    template <typename reward_type = float>
+    class transition_table
+    {
+    public:
+        /// @brief count every step of @param episode
+        void add(const compact_episode<reward_type>& episode);
+        /// @brief count every step of every episode of @param batch
+        void add(const episode_batch<reward_type>& batch);
+        /// @brief order the transitions by state and action
+        void sort();
+        /// @brief call @param f with the [first, last) transitions of every state and action
+        /// @warning only after `sort`
+        template <class function>
+        void for_each_pair(function f) const;
+        /// @return amount of unique transitions
+        std::size_t size() const;
+        /// @return amount of counted steps
+        std::uint64_t samples() const;
+        /// @return transition @param index
+        const transition_count<reward_type>& operator[](std::size_t index) const;
+        /// @return about the bytes used by the transitions and their index
+        std::size_t memory() const;
+    protected:
+        std::vector<transition_count<reward_type>> __transitions__;
+        // transition => its position in `__transitions__`
+        std::unordered_map<transition_count<reward_type>,
+            std::uint32_t,
+            hasher<transition_count<reward_type>>,
+            equal<transition_count<reward_type>>
+        > __index__;
+        std::uint64_t __samples__ = 0;
+        bool __sorted__ = true;
+    };
+
+    /**
+     * @return index of the first highest of @param values
+     *
+     * The scan has a fixed length and selects instead of branching, so for the
+     * few actions of a state the compiler unrolls it into compares and conditional moves.
+     */
+    template <std::size_t count,
+        typename value_type>
+    std::size_t argmax(const value_type* values);
+
+    /**
+     * @brief the default storage of `policy`: nested maps [state][action] => value
+     * @class map_storage
+     * @version 0.1.0
+     * @date 19-October-2026
+     *
+     * Only needs hashable states and actions, but allocates a node per state
+     * and another one per action.
+     *
+     * Every storage class used by `policy` provides:
+     *  - `void set(const state_class&, const action_class&, value_type)`
+     *  - `value_type get(const state_class&, const action_class&) const` - zero if never set
+     *  - `void for_each(const state_class&, function) const` - calls `function(action, value)`
+     *    for every action that was set for the state
+     *  - `bool best(const state_class&, function) const` - calls `function(action, value)`
+     *    with the highest value of the state, false if no action was set
+     *  - `void for_each(function) const` - calls `function(state, action, value)`
+     *    for every value that was set
+     *  - `void serialize(archive&, const unsigned int)` when using boost serialization
+     *
+     * Only `set` may add states, reading an unknown state must not change the storage.
+     */
+    template <class state_class,
+        class action_class,
+        typename value_type = double>
+    class map_storage
+    {
+    public:
+        /// @brief set the value of a state/action pair
+        void set(const state_class& s_t,
+            const action_class& a_t,
+            value_type q);
+        /// @return value of a state/action pair - zero if never set
+        value_type get(const state_class& s_t,
+            const action_class& a_t) const;
+        /// @brief call @param f with every action/value of @param s_t
+        template <class function>
+        void for_each(const state_class& s_t, function f) const;
+        /// @brief call @param f with every state/action/value
+        template <class function>
+        void for_each(function f) const;
+        /// @brief call @param f with the action/value with the highest value of @param s_t
+        /// @return false if no action was set for @param s_t
+        template <class function>
+        bool best(const state_class& s_t, function f) const;
+#ifdef USING_BOOST_SERIALIZATION
+        // serialize method
+        template <typename archive>
+        void serialize(archive& ar, const unsigned int version);
+    protected:
+        // actual policies use the `_serial` wrapper from `serialize.tpl`
+        std::unordered_map<state_serial<state_class>,
+            std::unordered_map<action_serial<action_class>,
+            value_type,
+            hasher<action_serial<action_class>>>,
+            hasher<state_serial<state_class>>
+        > __policies__;
+#else
+    protected:
+        // policies maps is: [state][action][state_next] => Q-value
+        std::unordered_map<state_class,
+            std::unordered_map<action_class,
+            value_type,
+            hasher<action_class>>,
+            hasher<state_class>
+            > __policies__;
+#endif
+    };
+
+    /**
+     * @brief a storage which keeps all values in one flat array
+     * @class dense_storage
+     * @version 0.1.0
+     * @date 19-October-2026
+     *
+     * Instead of hashing states and actions the values are stored in a
+     * `value_type[state_count][action_count]` array. Use it when every state can
+     * be mapped to an index (e.g., a permutation rank), a state then costs
+     * `action_count * sizeof(value_type)` bytes and all its values are on one or two cache lines.
+     * The whole array is allocated on construction.
+     *
+     * Template parameter `indexer` maps states and actions to indices and must provide:
+     *  - `static const std::size_t state_count` and `static const std::size_t action_count`
+     *  - `static std::size_t state_index(const state_class&)` in `[0, state_count)`
+     *  - `static std::size_t action_index(const action_class&)` in `[0, action_count)`
+     *  - `static action_class action_at(std::size_t)` the inverse of `action_index`
+     *
+     * Pairs that were never set hold `unvisited()` and are skipped by `for_each`.
+     */
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type = float>
+    class dense_storage
+    {
+    public:
+        static const std::size_t action_count = indexer::action_count;
+        /// @brief allocates `state_count * action_count` unvisited values
+        dense_storage();
+        /// @brief set the value of a state/action pair
+        void set(const state_class& s_t,
+            const action_class& a_t,
+            value_type q);
+        /// @return value of a state/action pair - zero if never set
+        value_type get(const state_class& s_t,
+            const action_class& a_t) const;
+        /// @brief call @param f with every action/value of @param s_t
+        template <class function>
+        void for_each(const state_class& s_t, function f) const;
+        /// @brief call @param f with every state/action/value
+        /// @warning needs `static state_class state_at(std::size_t)` in `indexer`
+        template <class function>
+        void for_each(function f) const;
+        /// @brief call @param f with the action/value with the highest value of @param s_t (@see `argmax`)
+        /// @return false if no action was set for @param s_t
+        template <class function>
+        bool best(const state_class& s_t, function f) const;
+        /// @return the `action_count` values of @param s_t, never nullptr: the values of a state that was never set are `unvisited()`
+        const value_type* values(const state_class& s_t) const;
+        /// @return all `state_count * action_count` values
+        const value_type* data() const;
+        /// @return the `action_count` values of the state with index @param s
+        const value_type* values_at(std::size_t s) const;
+        /// @return the value of the state and action with indices @param s and @param a, `unvisited()` if never set
+        value_type get_at(std::size_t s, std::size_t a) const;
+        /// @brief set the value of the state and action with indices @param s and @param a
+        void set_at(std::size_t s,
+            std::size_t a,
+            value_type q);
+        /// @brief the value of a pair that was never set
+        static value_type unvisited();
+#ifdef USING_BOOST_SERIALIZATION
+        // serialize method - throws std::length_error when a loaded archive has another size
+        template <typename archive>
+        void serialize(archive& ar, const unsigned int version);
+#endif
+    protected:
+        // values are [state_index * action_count + action_index] => Q-value
+        std::vector<value_type> __values__;
+    };
+
+    /**
+     * @brief a storage which keeps the values of a state in one open addressing hash table
+     * @class flat_map_storage
+     * @version 0.1.0
+     * @date 19-October-2026
+     *
+     * For states that can not be ranked, but with actions that can (@see `dense_storage`,
+     * only the action part of `indexer` is used). Every state has one entry holding
+     * an inline `value_type[action_count]` array, the entries are kept in a vector
+     * and found through a Robin Hood hash table of 8 byte buckets (32 bit hash, 32 bit entry).
+     * There are no allocations besides growing those vectors, whereas `map_storage`
+     * allocates a node per state and per action.
+     *
+     * Pairs that were never set hold `unvisited()` and are skipped by `for_each`.
+     * States can not be removed.
+     */
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type = float>
+    class flat_map_storage
+    {
+    public:
+        /// @brief the values of one state
+        using values_type = std::array<value_type, indexer::action_count>;
+        /// @brief set the value of a state/action pair
+        void set(const state_class& s_t,
+            const action_class& a_t,
+            value_type q);
+        /// @return value of a state/action pair - zero if never set
+        value_type get(const state_class& s_t,
+            const action_class& a_t) const;
+        /// @brief call @param f with every action/value of @param s_t
+        template <class function>
+        void for_each(const state_class& s_t, function f) const;
+        /// @brief call @param f with every state/action/value
+        template <class function>
+        void for_each(function f) const;
+        /// @brief call @param f with the action/value with the highest value of @param s_t (@see `argmax`)
+        /// @return false if no action was set for @param s_t
+        template <class function>
+        bool best(const state_class& s_t, function f) const;
+        /// @return the `action_count` values of @param s_t, nullptr if the state is unknown
+        const value_type* values(const state_class& s_t) const;
+        /// @return amount of states
+        std::size_t size() const;
+        /// @brief the value of a pair that was never set
+        static value_type unvisited();
+#ifdef USING_BOOST_SERIALIZATION
+        // serialize method - the states are written with the `_serial` wrapper
+        template <typename archive>
+        void serialize(archive& ar, const unsigned int version);
+        template <typename archive>
+        void save(archive& ar, const unsigned int version) const;
+        template <typename archive>
+        void load(archive& ar, const unsigned int version);
+#endif
+    protected:
+        // a bucket with `hash == 0` is empty, the highest bit of every hash is set
+        struct bucket
+        {
+            std::uint32_t hash;
+            std::uint32_t entry;
+        };
+        static const std::size_t npos = static_cast<std::size_t>(-1);
+        // @return entry of @param s_t or `npos`
+        std::size_t find(const state_class& s_t, std::uint32_t hash) const;
+        // @return entry of @param s_t, a new entry with unvisited values if not found
+        std::size_t find_or_insert(const state_class& s_t);
+        // put @param arg in the table, moving buckets that are closer to their slot
+        void insert_bucket(bucket arg);
+        // double the amount of buckets
+        void grow();
+        static std::uint32_t hash_of(const state_class& s_t);
+        std::vector<bucket> __buckets__;
+        std::vector<state_class> __states__;
+        std::vector<values_type> __values__;
+    };
+
+    /**
+     * @brief a read-only `dense_storage` over values it does not own
+     * @class dense_view_storage
+     * @version 0.1.0
+     * @date 19-October-2026
+     *
+     * The values have the layout of `dense_storage` (`value_type[state_count][action_count]`,
+     * unvisited pairs hold `unvisited()`) but live somewhere else, e.g., in a memory mapped
+     * file, and must outlive the storage. Nothing is copied, so a policy using it is ready
+     * as soon as the values are.
+     *
+     * There is no `set`, so `policy::update` and `q_learning` can not be used with it.
+     */
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type = float>
+    class dense_view_storage
+    {
+    public:
+        static const std::size_t action_count = indexer::action_count;
+        /// @brief view @param values of `state_count * action_count` values
+        explicit dense_view_storage(const value_type* values);
+        /// @return value of a state/action pair - zero if never set
+        value_type get(const state_class& s_t,
+            const action_class& a_t) const;
+        /// @brief call @param f with every action/value of @param s_t
+        template <class function>
+        void for_each(const state_class& s_t, function f) const;
+        /// @brief call @param f with every state/action/value
+        /// @warning needs `static state_class state_at(std::size_t)` in `indexer`
+        template <class function>
+        void for_each(function f) const;
+        /// @brief call @param f with the action/value with the highest value of @param s_t (@see `argmax`)
+        /// @return false if no action was set for @param s_t
+        template <class function>
+        bool best(const state_class& s_t, function f) const;
+        /// @return the `action_count` values of @param s_t
+        const value_type* values(const state_class& s_t) const;
+        /// @return the `action_count` values of the state with index @param s
+        const value_type* values_at(std::size_t s) const;
+        /// @return the value of the state and action with indices @param s and @param a, `unvisited()` if never set
+        value_type get_at(std::size_t s, std::size_t a) const;
+        /// @brief the value of a pair that was never set
+        static value_type unvisited();
+    protected:
+        // values are [state_index * action_count + action_index] => Q-value
+        const value_type* __values__;
+    };
+
+    /**
+     * @brief a `dense_storage` which several threads can update at the same time
+     * @class atomic_dense_storage
+     * @version 0.1.0
+     * @date 19-October-2026
+     *
+     * Every value is a `std::atomic<value_type>` which is read and written with relaxed
+     * loads and stores, on common hardware these are plain moves. There are no locks:
+     * like Hogwild! SGD, threads learning different episodes update the values without
+     * waiting for each other. A read-modify-write (e.g., `q + α * (G - q)`) is not atomic,
+     * so when two threads update the same pair at the same time one update can be lost.
+     * Rare for a big state space, and Q-learning converges anyway.
+     *
+     * `values_at` returns a copy of the values of a state instead of a pointer, the other
+     * threads may change them while they are being read. There is no serialization, copy
+     * the values out with `copy` (e.g., to a `PolicyFile`) or into a `dense_storage`.
+     */
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type = float>
+    class atomic_dense_storage
+    {
+    public:
+        static const std::size_t action_count = indexer::action_count;
+        /// @brief the values of one state
+        using values_type = std::array<value_type, indexer::action_count>;
+        /// @brief allocates `state_count * action_count` unvisited values
+        atomic_dense_storage();
+        /// @brief copies @param values of `state_count * action_count` values, e.g., from `dense_storage::data`
+        explicit atomic_dense_storage(const value_type* values);
+        /// @brief set the value of a state/action pair
+        void set(const state_class& s_t,
+            const action_class& a_t,
+            value_type q);
+        /// @return value of a state/action pair - zero if never set
+        value_type get(const state_class& s_t,
+            const action_class& a_t) const;
+        /// @brief call @param f with every action/value of @param s_t
+        template <class function>
+        void for_each(const state_class& s_t, function f) const;
+        /// @brief call @param f with every state/action/value
+        /// @warning needs `static state_class state_at(std::size_t)` in `indexer`
+        template <class function>
+        void for_each(function f) const;
+        /// @brief call @param f with the action/value with the highest value of @param s_t (@see `argmax`)
+        /// @return false if no action was set for @param s_t
+        template <class function>
+        bool best(const state_class& s_t, function f) const;
+        /// @brief copy all `state_count * action_count` values to @param values
+        void copy(value_type* values) const;
+        /// @return a copy of the `action_count` values of the state with index @param s
+        values_type values_at(std::size_t s) const;
+        /// @return the value of the state and action with indices @param s and @param a, `unvisited()` if never set
+        value_type get_at(std::size_t s, std::size_t a) const;
+        /// @brief set the value of the state and action with indices @param s and @param a
+        void set_at(std::size_t s,
+            std::size_t a,
+            value_type q);
+        /// @brief the value of a pair that was never set
+        static value_type unvisited();
+    protected:
+        // values are [state_index * action_count + action_index] => Q-value
+        std::unique_ptr<std::atomic<value_type>[]> __values__;
+    };
+
     /**
      * @brief the class which encapsulates learnt policies, actions and values
      * @class policy
@@ -203,79 +821,119 @@ namespace relearn
      *
      * Template parameter `value_type` defaults to a double, but feel free to change it
      *
+     * Template parameter `storage_class` is where the values are kept, by default in
+     * nested maps (@see `map_storage`). For states that can be indexed use `dense_storage`
+     * (@see `dense_policy`), for others `flat_map_storage` (@see `flat_policy`). Threads
+     * that learn at the same time share an `atomic_dense_storage` (@see `atomic_dense_policy`).
+     *
      * This class owns all mapped state-action-policy values (it keeps copies)
+     * Only `update` adds states, looking up the values of an unknown state does not.
      * It learns which are better than others, by observing terminal state rewards.
      * The actual **value** is not calculated in this class (it is agnostic in that
      * respect) but is instead calculated using another algorith (Q-Learning, etc.)
      *
      * Use this class in combination with an algorithm to train it (e.g., `q_learning`)
      *
-     * If you need access to the underlying policies (std::unordered_map) then you
-     * must inherit from this class. By doing so you accept responsibility since
+     * `storage()` gives read-only access to the underlying storage. If you need
+     * write access then you must inherit from this class. By doing so you accept responsibility since
      * you will have read-write access directly.
      */
     template <class state_class,
         class action_class,
-        typename value_type = double>
+        typename value_type = double,
+        class storage_class = map_storage<state_class, action_class, value_type>>
     class policy
     {
     public:
+        /// @brief where the values are kept
+        using storage_type = storage_class;
+        /// @brief an empty policy
+        policy() = default;
+        /// @brief a policy with the values of @param storage
+        explicit policy(storage_class storage);
         /// @brief action_map correlates a state to its experienced actions/values
         using action_map = std::unordered_map<action_class,
             value_type,
             hasher<action_class>>;
         /// @return actions experienced for this state
-        action_map actions(state_class s_t);
+        action_map actions(const state_class& s_t) const;
         /// @brief update a policy value
-        void update(state_class s_t,
-            action_class a_t,
+        void update(const state_class& s_t,
+            const action_class& a_t,
             value_type q_value);
         /// @return value of policy
-        value_type value(state_class s_t,
-            action_class a_t);
+        value_type value(const state_class& s_t,
+            const action_class& a_t) const;
         /// @return max/best policy for @param state
-        value_type best_value(state_class s_t);
+        value_type best_value(const state_class& s_t) const;
         /**
          * @return best policy for @param state -
          * @warning if none are found, returns nullptr
          */
-        std::unique_ptr<action_class> best_action(state_class s_t);
+        std::unique_ptr<action_class> best_action(const state_class& s_t) const;
         /**
          * @return a pair of action/value if one exists or a
          * pair of <nullptr,0> if one doesn't exist
          */
-        std::pair<std::unique_ptr<action_class>, value_type> best(state_class s_t);
+        std::pair<std::unique_ptr<action_class>, value_type> best(const state_class& s_t) const;
         /**
          * @brief concatenate policies, using @param arg
          * @warning the policy Q-values of @param arg take precedence `this` policies,
          * meaning that if duplicates are found, `arg`'s values will be used,
          * thereby overwritting old Q-values stored
          */
-        void operator+=(const policy<state_class, action_class, value_type>& arg);
+        void operator+=(const policy<state_class, action_class, value_type, storage_class>& arg);
+        /// @return read-only access to the storage, e.g., to copy its values
+        const storage_class& storage() const;
+        /**
+         * @brief `value`, `best_value` and `update` with the indices of a state and action
+         * @warning only for storages that index states (@see `dense_storage`, `atomic_dense_storage`)
+         */
+        value_type value_at(std::size_t s, std::size_t a) const;
+        value_type best_value_at(std::size_t s) const;
+        void update_at(std::size_t s, std::size_t a, value_type q);
     protected:
 #ifdef USING_BOOST_SERIALIZATION
         friend class boost::serialization::access;
-        // serialize method
+        // serialize method - writes the storage without a wrapper
         template <typename archive>
         void serialize(archive& ar, const unsigned int version);
-        // actual policies use the `_serial` wrapper from `serialize.tpl`
-        std::unordered_map<state_serial<state_class>,
-            std::unordered_map<action_serial<action_class>,
-            value_type,
-            hasher<action_serial<action_class>>>,
-            hasher<state_serial<state_class>>
-        > __policies__;
-#else
-        // policies maps is: [state][action][state_next] => Q-value
-        std::unordered_map<state_class,
-            std::unordered_map<action_class,
-            value_type,
-            hasher<action_class>>,
-            hasher<state_class>
-            > __policies__;
 #endif
+        storage_class __storage__;
     };
 
+    /// @brief a policy with all values in one array (@see `dense_storage`)
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type = float>
+    using dense_policy = policy<state_class, action_class, value_type,
+        dense_storage<state_class, action_class, indexer, value_type>>;
+
+    /// @brief a policy with the values in an open addressing hash table (@see `flat_map_storage`)
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type = float>
+    using flat_policy = policy<state_class, action_class, value_type,
+        flat_map_storage<state_class, action_class, indexer, value_type>>;
+
+    /// @brief a read-only policy over values it does not own (@see `dense_view_storage`)
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type = float>
+    using dense_view_policy = policy<state_class, action_class, value_type,
+        dense_view_storage<state_class, action_class, indexer, value_type>>;
+
+    /// @brief a policy which several threads can learn at the same time (@see `atomic_dense_storage`)
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type = float>
+    using atomic_dense_policy = policy<state_class, action_class, value_type,
+        atomic_dense_storage<state_class, action_class, indexer, value_type>>;
+
     /*******************************************************************************
      * @class q_learning This is the **deterministic** Q-Learning algorithm
      * @brief Q-Learning update algorithm sets policies using episodes (`markov_chain`)
@@ -302,76 +960,296 @@ namespace relearn
         /// discount rate - you may change this as you process episodes
         value_type gamma = 0.9;
         /// @brief the update rule of Q-learning
-        triplet q_value(markov_chain& episode,
+        template <class policy_class>
+        triplet q_value(const markov_chain& episode,
             unsigned int index,
-            policy<state_class, action_class>& policy_map);
+            policy_class& policy_map);
 
-        /// @brief do the updating for an episode - @param policy_map will be modified
-        void operator()(markov_chain episode,
-            policy<state_class, action_class>& policy_map);
+        /**
+         * @brief do the updating for an episode - @param policy_map will be modified
+         * @note `policy_class` is a `policy<state_class, action_class>` with any
+         * value type and storage (e.g., `dense_policy`)
+         */
+        template <class policy_class>
+        void operator()(const markov_chain& episode,
+            policy_class& policy_map);
+
+        /**
+         * @brief do the updating for the links in [@param first, @param last)
+         * @note the links are only read through references, no state or action is copied
+         */
+        template <class iterator,
+            class policy_class>
+        void operator()(iterator first,
+            iterator last,
+            policy_class& policy_map);
+
+        /**
+         * @brief the same updates for a compact episode (@see `episode_batch`)
+         * @note `policy_class` must have an index based storage (@see `policy::update_at`)
+         */
+        template <class policy_class,
+            typename reward_type>
+        void operator()(const compact_episode<reward_type>& episode,
+            policy_class& policy_map);
+
+        /**
+         * @brief the update of one transition, e.g., sampled from a `prioritized_replay`
+         * @return its TD error: the target minus the value before the update
+         */
+        template <class policy_class>
+        value_type operator()(const transition<link<state_class, action_class>>& arg,
+            policy_class& policy_map);
+        template <class policy_class,
+            typename reward_type>
+        value_type operator()(const transition<compact_link<reward_type>>& arg,
+            policy_class& policy_map);
+
+        /**
+         * @brief one update per state and action of @param table, towards the mean target of
+         * its transitions weighted by their counts (the last step of an episode is its reward)
+         * @note `policy_class` must have an index based storage (@see `policy::update_at`)
+         */
+        template <class policy_class,
+            typename reward_type>
+        void operator()(const transition_table<reward_type>& table,
+            policy_class& policy_map);
     };
 
-    /**
-     * @struct q_probabilistic This is the **non-deterministic** Q-Learning algorithm
-     * @brief Q-Learning updates policy values using various episodes (`markov_chain`)
+    /*******************************************************************************
+     * @class q_lambda Q-Learning with λ-returns, processing an episode backwards
+     * @brief a `q_learning` mode which propagates a reward through a whole episode in one pass
      * @param gamma is the discount rate
+     * @param alpha is the learning rate
+     * @param lambda is the weight of the longer returns
+     * @date 19-October-2026
+     * @version 0.1.0
      *
-     * Algorithm uses transition probabilities (e.g., from s_t → s_t+1) mapped by `r`
-     * The probability of a transition `r` is `P(s_t,a_t) = Σ P(s_t,a_t)(s_t,s_t+1)`
-     * relies on classical probability on the frequency of the transition with respect
-     * to the total observations of `P(s_t,a_t)` regardless of transition (the sum).
-     * Thus our **expected reward** is `E(r)` is the value of the reward of that
-     * transition probability. We do not reward the transition, but the ending state s_t+1
-     * thus R = R(s_t+1) and we assume the Reward to be **Stationary** (e.g., non-changing).
-     * The Policy Value V(s_t) = Max Q(s_t,a_t), therefore our update rule in combination
-     * with the expected reward, is:
+     * `q_learning` walks an episode forwards, so a reward at its end moves back one
+     * step per pass. This class walks it backwards and updates every step towards the
+     * λ-return, which is computed from the return of the step after it:
      *
-     * Q(s_t,a_t) ← E(R(s_t+1)) + γ  Σ maxQ(s_t+1,a_t) P(s_t,a_t)(s_t+1)`
+     * G_t = r_t + γ * ((1 - λ) * max(Q(s_{t+1}, a)) + λ * G_{t+1})
      *
-     * or verbalised: the Expected reward of the transitional state (the state we expect to end to)
-     * plus the discoun multiplied by the cumulative probability of the transition (s_t → s_t+1)
-     * times the max Q value of the next state Q(s_t+1,a_t).
+     * Q(s_t,a_t) = Q(s_t,a_t) + α * (G_t - Q(s_t,a_t))
+     *
+     * With λ = 0 this is the `q_learning` rule, but max(Q(s_{t+1}, a)) is already updated
+     * in the same pass. With λ = 1 it is the discounted return of the rest of the episode.
+     * This is the offline (forward view) form of Peng's Q(λ) eligibility traces, the
+     * returns are not cut at exploratory actions. The last step of an episode is set to
+     * its reward, like in `q_learning`.
      */
     template <class state_class,
         class action_class,
         typename markov_chain = std::deque<link<state_class, action_class>>,
         typename value_type = double>
-    struct q_probabilistic
+    struct q_lambda
     {
-        // Q-triplet: state,action => value
-        using triplet = std::tuple<state_class,
-            action_class,
-            value_type>;
-        /// discount rate - you can change this as you process episodes
+        /// learning rate - you may change this as you process episodes
+        value_type alpha = 0.9;
+        /// discount rate - you may change this as you process episodes
         value_type gamma = 0.9;
-        /// default empty ctor - discount will be 0.9
-        q_probabilistic() = default;
-        /// default ctor with discount
-        q_probabilistic(value_type discount);
-        /// @brief the update rule of Q-learning
-        triplet q_value(markov_chain& episode,
-            unsigned int index,
-            policy<state_class, action_class>& policy_map);
+        /// weight of the longer returns, 0 for one step returns
+        value_type lambda = 0;
         /// @brief do the updating for an episode - @param policy_map will be modified
-        void operator()(markov_chain episode,
-            policy<state_class, action_class>& policy_map);
-    private:
-        // map of state, frequency (s_t_+1)
-        using frequency = std::unordered_map<state_class,
-            std::size_t,
-            hasher<state_class>
-        >;
-        // frequency of transition map from a_t to (s_t+1)
-        using transition = std::unordered_map<action_class,
-            frequency,
-            hasher<action_class>
-        >;
-        // frequency of observation of transition (s_t,a_t) → (s_t+1)
-        using observation = std::unordered_map<state_class,
-            transition,
-            hasher<state_class>
-        >;
-        observation __memory__;
+        template <class policy_class>
+        void operator()(const markov_chain& episode,
+            policy_class& policy_map);
+        /// @brief do the updating for the links in [@param first, @param last) - needs bidirectional iterators
+        template <class iterator,
+            class policy_class>
+        void operator()(iterator first,
+            iterator last,
+            policy_class& policy_map);
+        /**
+         * @brief the same updates for a compact episode (@see `episode_batch`)
+         * @note `policy_class` must have an index based storage (@see `policy::update_at`)
+         */
+        template <class policy_class,
+            typename reward_type>
+        void operator()(const compact_episode<reward_type>& episode,
+            policy_class& policy_map);
+    };
+
+    /**
+     * @brief the default transition model of `q_probabilistic`: one hash map [state, action] => successors
+     * @class map_model
+     * @version 0.1.0
+     * @date 19-October-2026
+     *
+     * Counts how often every next state followed a state and action. Only needs hashable
+     * states and actions. A state and action is one lookup, its successors are a short
+     * vector which is searched (one entry for deterministic transitions).
+     *
+     * Every model class used by `q_probabilistic` provides:
+     *  - `void observe(const state_class&, const action_class&, const state_class&)` - counts a transition
+     *  - `double probability(const state_class&, const action_class&, const state_class&) const` -
+     *    the count of the transition divided by all counts of the state and action, zero if never observed
+     *
+     * Reading a transition that was never observed must not change the model.
+     */
+    template <class state_class,
+        class action_class>
+    class map_model
+    {
+    public:
+        /// @brief count that @param s_next followed @param s_t and @param a_t
+        void observe(const state_class& s_t,
+            const action_class& a_t,
+            const state_class& s_next);
+        /// @return the frequency of @param s_next after @param s_t and @param a_t
+        double probability(const state_class& s_t,
+            const action_class& a_t,
+            const state_class& s_next) const;
+        /// @return amount of observed states and actions
+        std::size_t size() const;
+    protected:
+        struct key
+        {
+            state_class state;
+            action_class action;
+            bool operator==(const key& arg) const;
+        };
+        struct key_hasher
+        {
+            std::size_t operator()(const key& arg) const;
+        };
+        struct successors
+        {
+            std::size_t total = 0;
+            std::vector<std::pair<state_class, std::size_t>> counts;
+        };
+        std::unordered_map<key, successors, key_hasher> __pairs__;
+    };
+
+    /**
+     * @brief a transition model for states and actions that can be indexed (@see `dense_storage`)
+     * @class dense_model
+     * @version 0.1.0
+     * @date 19-October-2026
+     *
+     * Keeps the index of the first observed next state and its count in two arrays of
+     * `state_count * action_count`, 8 bytes per state and action. Deterministic transitions
+     * (e.g., turning a cube) only ever have that one successor, others are kept in a hash map
+     * which stays empty for them.
+     */
+    template <class state_class,
+        class action_class,
+        class indexer>
+    class dense_model
+    {
+    public:
+        /// @brief allocates `state_count * action_count` unobserved pairs
+        dense_model();
+        /// @brief count that @param s_next followed @param s_t and @param a_t
+        void observe(const state_class& s_t,
+            const action_class& a_t,
+            const state_class& s_next);
+        /// @return the frequency of @param s_next after @param s_t and @param a_t
+        double probability(const state_class& s_t,
+            const action_class& a_t,
+            const state_class& s_next) const;
+        /// @return about the bytes used
+        std::size_t memory() const;
+    protected:
+        // the next state of a pair that was never observed
+        static std::uint32_t unobserved();
+        // [state_index * action_count + action_index] => index of the first next state and its count
+        std::vector<std::uint32_t> __next__;
+        std::vector<std::uint32_t> __counts__;
+        // state and action => the other next states and their counts
+        std::unordered_map<std::size_t, std::vector<std::pair<std::uint32_t, std::uint32_t>>> __others__;
+    };
+
+    /**
+     * @struct q_probabilistic This is the **non-deterministic** Q-Learning algorithm
+     * @brief Q-Learning updates policy values using various episodes (`markov_chain`)
+     * @param gamma is the discount rate
+     *
+     * Algorithm uses transition probabilities (e.g., from s_t → s_t+1) mapped by `r`
+     * The probability of a transition `r` is `P(s_t,a_t) = Σ P(s_t,a_t)(s_t,s_t+1)`
+     * relies on classical probability on the frequency of the transition with respect
+     * to the total observations of `P(s_t,a_t)` regardless of transition (the sum).
+     * Thus our **expected reward** is `E(r)` is the value of the reward of that
+     * transition probability. We do not reward the transition, but the ending state s_t+1
+     * thus R = R(s_t+1) and we assume the Reward to be **Stationary** (e.g., non-changing).
+     * The Policy Value V(s_t) = Max Q(s_t,a_t), therefore our update rule in combination
+     * with the expected reward, is:
+     *
+     * Q(s_t,a_t) ← E(R(s_t+1)) + γ  Σ maxQ(s_t+1,a_t) P(s_t,a_t)(s_t+1)`
+     *
+     * or verbalised: the Expected reward of the transitional state (the state we expect to end to)
+     * plus the discoun multiplied by the cumulative probability of the transition (s_t → s_t+1)
+     * times the max Q value of the next state Q(s_t+1,a_t).
+     *
+     * Template parameter `model_class` counts the observed transitions, by default in one hash
+     * map (@see `map_model`). For states that can be indexed use `dense_model`.
+     */
+    template <class state_class,
+        class action_class,
+        typename markov_chain = std::deque<link<state_class, action_class>>,
+        typename value_type = double,
+        class model_class = map_model<state_class, action_class>>
+    struct q_probabilistic
+    {
+        // Q-triplet: state,action => value
+        using triplet = std::tuple<state_class,
+            action_class,
+            value_type>;
+        /// discount rate - you can change this as you process episodes
+        value_type gamma = 0.9;
+        /// default empty ctor - discount will be 0.9
+        q_probabilistic() = default;
+        /// default ctor with discount
+        q_probabilistic(value_type discount);
+        /// @brief the update rule of Q-learning
+        template <class policy_class>
+        triplet q_value(const markov_chain& episode,
+            unsigned int index,
+            policy_class& policy_map);
+        /// @brief do the updating for an episode - @param policy_map will be modified
+        template <class policy_class>
+        void operator()(const markov_chain& episode,
+            policy_class& policy_map);
+        /// @brief do the updating for the links in [@param first, @param last)
+        template <class iterator,
+            class policy_class>
+        void operator()(iterator first,
+            iterator last,
+            policy_class& policy_map);
+        /// @brief count the transition @param arg, once for every time it was experienced (`operator()` of an episode does this)
+        void observe(const relearn::transition<link<state_class, action_class>>& arg);
+        /**
+         * @brief the update of one observed transition, e.g., sampled from a `prioritized_replay`
+         * @return its TD error: the new value minus the value before the update
+         */
+        template <class policy_class>
+        value_type operator()(const relearn::transition<link<state_class, action_class>>& arg,
+            policy_class& policy_map);
+        /**
+         * @brief the update rule with the frequencies of the transitions of @param table,
+         * one update per state and action
+         * @note `policy_class` must have an index based storage (@see `policy::update_at`)
+         */
+        template <class policy_class,
+            typename reward_type>
+        void operator()(const transition_table<reward_type>& table,
+            policy_class& policy_map);
+    private:
+        // @return the expected value of the [@param first, @param last) transitions of a state and action
+        template <class policy_class,
+            typename reward_type>
+        value_type expected_value(const transition_count<reward_type>* first,
+            const transition_count<reward_type>* last,
+            policy_class& policy_map);
+        // @return the value of @param step followed by @param next (`q_value`)
+        template <class link_class,
+            class policy_class>
+        value_type q_value(const link_class& step,
+            const link_class& next,
+            policy_class& policy_map);
+        // frequency of observation of transition (s_t,a_t) → (s_t+1)
+        model_class __memory__;
     };
 
     /********************************************************************************
@@ -424,257 +1302,1676 @@ namespace relearn
         typename value_type>
     value_type state<state_trait, value_type>::reward() const
     {
-        return __reward__;
+        return __reward__;
+    }
+
+    template <class state_trait,
+        typename value_type>
+    void state<state_trait, value_type>::set_reward(value_type reward)
+    {
+        __reward__ = reward;
+    }
+
+    template <class state_trait,
+        typename value_type>
+    bool state<state_trait, value_type>::operator==(const state<state_trait>& arg) const
+    {
+        return (this->__trait__ == arg.__trait__);
+    }
+
+    template <class state_trait,
+        typename value_type>
+    bool state<state_trait, value_type>::operator<(const state<state_trait>& arg) const
+    {
+        return (this->__trait__ < arg.__trait__);
+    }
+
+    template <class state_trait,
+        typename value_type>
+    std::size_t state<state_trait, value_type>::hash() const
+    {
+        return std::hash<state_trait>{}(__trait__);
+    }
+
+    template <class state_trait,
+        typename value_type>
+    state_trait state<state_trait, value_type>::trait() const
+    {
+        return __trait__;
+    }
+
+#ifdef USING_BOOST_SERIALIZATION
+    template <class state_trait,
+        typename value_type>
+    template <typename archive>
+    void state<state_trait, value_type>::serialize(archive& ar,
+        const unsigned int version)
+    {
+        ar& __trait__;
+        ar& __reward__;
+    }
+#endif
+
+    template <class action_trait>
+    action<action_trait>::action(action_trait trait)
+        : __trait__(trait)
+    {}
+
+    template <class action_trait>
+    std::size_t action<action_trait>::hash() const
+    {
+        return std::hash<action_trait>{}(__trait__);
+    }
+
+    template <class action_trait>
+    bool action<action_trait>::operator==(const action<action_trait>& arg) const
+    {
+        return (this->__trait__ == arg.__trait__);
+    }
+
+    template <class action_trait>
+    bool action<action_trait>::operator<(const action<action_trait>& arg) const
+    {
+        return (this->__trait__ < arg.__trait__);
+    }
+
+    template <class action_trait>
+    action_trait action<action_trait>::trait() const
+    {
+        return __trait__;
+    }
+
+#ifdef USING_BOOST_SERIALIZATION
+    template <class action_trait>
+    template <typename archive>
+    void action<action_trait>::serialize(archive& ar,
+        const unsigned int version)
+    {
+        ar& __trait__;
+    }
+#endif
+
+    template <class state_class,
+        class action_class>
+    bool link<state_class, action_class>::operator<(const link<state_class,
+        action_class>& arg) const
+    {
+        return (this->action < arg.action) &&
+            (this->state < arg.state);
+    }
+
+    template <class state_class,
+        class action_class>
+    bool link<state_class, action_class>::operator==(const link<state_class,
+        action_class>& arg) const
+    {
+        return (this->action == arg.action) &&
+            (this->state == arg.state);
+    }
+
+    template <typename reward_type>
+    std::size_t compact_episode<reward_type>::size() const
+    {
+        return static_cast<std::size_t>(last - first);
+    }
+
+    template <typename reward_type>
+    const compact_link<reward_type>& compact_episode<reward_type>::operator[](std::size_t index) const
+    {
+        return first[index];
+    }
+
+    template <typename reward_type>
+    void episode_batch<reward_type>::push_back(std::uint32_t s_t,
+        std::uint8_t a_t,
+        reward_type r)
+    {
+        assert(s_t < compact_link<reward_type>::max_state_count);
+        __links__.push_back(compact_link<reward_type>{ s_t, a_t, r });
+    }
+
+    template <typename reward_type>
+    void episode_batch<reward_type>::end_episode()
+    {
+        __ends__.push_back(static_cast<std::uint32_t>(__links__.size()));
+    }
+
+    template <typename reward_type>
+    std::size_t episode_batch<reward_type>::size() const
+    {
+        return __ends__.size();
+    }
+
+    template <typename reward_type>
+    compact_episode<reward_type> episode_batch<reward_type>::operator[](std::size_t index) const
+    {
+        const std::uint32_t begin = index > 0 ? __ends__[index - 1] : 0;
+        return compact_episode<reward_type>{ __links__.data() + begin,
+            __links__.data() + __ends__[index] };
+    }
+
+    template <typename reward_type>
+    std::size_t episode_batch<reward_type>::memory() const
+    {
+        return __links__.capacity() * sizeof(compact_link<reward_type>)
+            + __ends__.capacity() * sizeof(std::uint32_t);
+    }
+
+    template <typename reward_type>
+    void episode_batch<reward_type>::shrink_to_fit()
+    {
+        __links__.shrink_to_fit();
+        __ends__.shrink_to_fit();
+    }
+
+    template <typename value_type>
+    sum_tree<value_type>::sum_tree(std::size_t capacity)
+        : __leaves__(1)
+    {
+        while (__leaves__ < capacity) __leaves__ *= 2;
+        __nodes__.assign(2 * __leaves__, value_type(0));
+    }
+
+    template <typename value_type>
+    void sum_tree<value_type>::set(std::size_t index, value_type priority)
+    {
+        std::size_t node = __leaves__ + index;
+        __nodes__[node] = priority;
+        // the sums are added again instead of adding the difference, so rounding errors do not pile up
+        while (node > 1) {
+            node /= 2;
+            __nodes__[node] = __nodes__[2 * node] + __nodes__[2 * node + 1];
+        }
+    }
+
+    template <typename value_type>
+    value_type sum_tree<value_type>::get(std::size_t index) const
+    {
+        return __nodes__[__leaves__ + index];
+    }
+
+    template <typename value_type>
+    value_type sum_tree<value_type>::total() const
+    {
+        return __nodes__[1];
+    }
+
+    template <typename value_type>
+    std::size_t sum_tree<value_type>::find(value_type prefix) const
+    {
+        std::size_t node = 1;
+        while (node < __leaves__) {
+            const value_type left = __nodes__[2 * node];
+            // a prefix rounded up to the total must not end in an empty right subtree
+            if (prefix < left || __nodes__[2 * node + 1] <= 0) {
+                node = 2 * node;
+            }
+            else {
+                prefix -= left;
+                node = 2 * node + 1;
+            }
+        }
+        return node - __leaves__;
+    }
+
+    template <class transition_class,
+        typename value_type>
+    prioritized_replay<transition_class, value_type>::prioritized_replay(std::size_t capacity,
+        value_type alpha,
+        value_type epsilon)
+        : __priorities__(capacity),
+        __capacity__(capacity),
+        __alpha__(alpha),
+        __epsilon__(epsilon)
+    {
+        __transitions__.reserve(capacity);
+    }
+
+    template <class transition_class,
+        typename value_type>
+    void prioritized_replay<transition_class, value_type>::push(const transition_class& arg)
+    {
+        if (__transitions__.size() < __capacity__) {
+            __transitions__.push_back(arg);
+        }
+        else {
+            __transitions__[__next__] = arg;
+        }
+        __priorities__.set(__next__, __max_priority__);
+        __next__ = (__next__ + 1) % __capacity__;
+    }
+
+    template <class transition_class,
+        typename value_type>
+    template <class episode_class>
+    void prioritized_replay<transition_class, value_type>::push_episode(const episode_class& episode)
+    {
+        for (std::size_t i = 0; i < episode.size(); i++) {
+            const bool last = i + 1 == episode.size();
+            push(transition_class{ episode[i], episode[last ? i : i + 1], last });
+        }
+    }
+
+    template <class transition_class,
+        typename value_type>
+    template <class generator>
+    std::size_t prioritized_replay<transition_class, value_type>::sample(generator& g) const
+    {
+        std::uniform_real_distribution<value_type> prefix(0, __priorities__.total());
+        return __priorities__.find(prefix(g));
+    }
+
+    template <class transition_class,
+        typename value_type>
+    template <class generator>
+    void prioritized_replay<transition_class, value_type>::sample(std::size_t count,
+        generator& g,
+        std::vector<std::size_t>& indices) const
+    {
+        // one draw per part spreads the samples over the buffer, the same transition is rarely drawn twice
+        const value_type part = __priorities__.total() / count;
+        std::uniform_real_distribution<value_type> prefix(0, part);
+        indices.resize(count);
+        for (std::size_t i = 0; i < count; i++) {
+            indices[i] = __priorities__.find(part * i + prefix(g));
+        }
+    }
+
+    template <class transition_class,
+        typename value_type>
+    const transition_class& prioritized_replay<transition_class, value_type>::operator[](std::size_t index) const
+    {
+        return __transitions__[index];
+    }
+
+    template <class transition_class,
+        typename value_type>
+    void prioritized_replay<transition_class, value_type>::update(std::size_t index, value_type td_error)
+    {
+        const value_type priority = std::pow(std::abs(td_error) + __epsilon__, __alpha__);
+        __max_priority__ = std::max(__max_priority__, priority);
+        __priorities__.set(index, priority);
+    }
+
+    template <class transition_class,
+        typename value_type>
+    void prioritized_replay<transition_class, value_type>::update(const std::vector<std::size_t>& indices,
+        const std::vector<value_type>& td_errors)
+    {
+        assert(indices.size() == td_errors.size());
+        for (std::size_t i = 0; i < indices.size(); i++) {
+            update(indices[i], td_errors[i]);
+        }
+    }
+
+    template <class transition_class,
+        typename value_type>
+    std::size_t prioritized_replay<transition_class, value_type>::size() const
+    {
+        return __transitions__.size();
+    }
+
+    template <class transition_class,
+        typename value_type>
+    std::size_t prioritized_replay<transition_class, value_type>::capacity() const
+    {
+        return __capacity__;
+    }
+
+    template <typename reward_type>
+    bool equal<transition_count<reward_type>
+    >::operator()(const transition_count<reward_type>& lhs,
+        const transition_count<reward_type>& rhs) const
+    {
+        return lhs.state == rhs.state && lhs.action == rhs.action && lhs.last == rhs.last
+            && lhs.next == rhs.next && lhs.reward == rhs.reward;
+    }
+
+    template <typename reward_type>
+    std::size_t hasher<transition_count<reward_type>
+    >::operator()(const transition_count<reward_type>& arg) const
+    {
+        std::size_t seed = 0;
+        hash_combine(seed, arg.state);
+        hash_combine(seed, arg.action);
+        hash_combine(seed, arg.last);
+        hash_combine(seed, arg.next);
+        hash_combine(seed, arg.reward);
+        return seed;
+    }
+
+    template <typename reward_type>
+    void transition_table<reward_type>::add(const compact_episode<reward_type>& episode)
+    {
+        for (std::size_t i = 0; i < episode.size(); i++) {
+            const compact_link<reward_type>& step = episode[i];
+            const bool last = i + 1 == episode.size();
+            const transition_count<reward_type> arg{ step.state, static_cast<std::uint8_t>(step.action), last,
+                last ? step.state : episode[i + 1].state, step.reward, 1 };
+            auto found = __index__.emplace(arg, static_cast<std::uint32_t>(__transitions__.size()));
+            if (found.second) {
+                __transitions__.push_back(arg);
+                __sorted__ = false;
+            }
+            else {
+                __transitions__[found.first->second].count++;
+            }
+        }
+        __samples__ += episode.size();
+    }
+
+    template <typename reward_type>
+    void transition_table<reward_type>::add(const episode_batch<reward_type>& batch)
+    {
+        for (std::size_t i = 0; i < batch.size(); i++) {
+            add(batch[i]);
+        }
+    }
+
+    template <typename reward_type>
+    void transition_table<reward_type>::sort()
+    {
+        if (__sorted__) return;
+        std::sort(__transitions__.begin(), __transitions__.end(),
+            [](const transition_count<reward_type>& lhs, const transition_count<reward_type>& rhs) {
+                return lhs.state != rhs.state ? rhs.state > lhs.state : rhs.action > lhs.action;
+            });
+        for (std::size_t i = 0; i < __transitions__.size(); i++) {
+            __index__[__transitions__[i]] = static_cast<std::uint32_t>(i);
+        }
+        __sorted__ = true;
+    }
+
+    template <typename reward_type>
+    template <class function>
+    void transition_table<reward_type>::for_each_pair(function f) const
+    {
+        assert(__sorted__);
+        const transition_count<reward_type>* first = __transitions__.data();
+        const transition_count<reward_type>* end = first + __transitions__.size();
+        while (first != end) {
+            const transition_count<reward_type>* last = first + 1;
+            while (last != end && last->state == first->state && last->action == first->action) last++;
+            f(first, last);
+            first = last;
+        }
+    }
+
+    template <typename reward_type>
+    std::size_t transition_table<reward_type>::size() const
+    {
+        return __transitions__.size();
+    }
+
+    template <typename reward_type>
+    std::uint64_t transition_table<reward_type>::samples() const
+    {
+        return __samples__;
+    }
+
+    template <typename reward_type>
+    const transition_count<reward_type>& transition_table<reward_type>::operator[](std::size_t index) const
+    {
+        return __transitions__[index];
+    }
+
+    template <typename reward_type>
+    std::size_t transition_table<reward_type>::memory() const
+    {
+        // a node of the index holds the key, its position and a next pointer
+        return __transitions__.capacity() * sizeof(transition_count<reward_type>)
+            + __index__.size() * (sizeof(transition_count<reward_type>) + 2 * sizeof(void*))
+            + __index__.bucket_count() * sizeof(void*);
+    }
+
+    template <std::size_t count,
+        typename value_type>
+    std::size_t argmax(const value_type* values)
+    {
+        static_assert(count > 0, "argmax of no values");
+        std::size_t index = 0;
+        value_type max = values[0];
+        for (std::size_t i = 1; i < count; i++) {
+            const bool higher = max < values[i];
+            index = higher ? i : index;
+            max = higher ? values[i] : max;
+        }
+        return index;
+    }
+
+    template <class state_class,
+        class action_class,
+        typename value_type>
+    void map_storage<state_class, action_class, value_type>::set(const state_class& s_t,
+        const action_class& a_t,
+        value_type q)
+    {
+        __policies__[s_t][a_t] = q;
+    }
+
+    template <class state_class,
+        class action_class,
+        typename value_type>
+    value_type map_storage<state_class, action_class, value_type>::get(const state_class& s_t,
+        const action_class& a_t) const
+    {
+        auto state = __policies__.find(s_t);
+        if (state == __policies__.end()) return value_type(0);
+        auto action = state->second.find(a_t);
+        return action != state->second.end() ? action->second : value_type(0);
+    }
+
+    template <class state_class,
+        class action_class,
+        typename value_type>
+    template <class function>
+    void map_storage<state_class, action_class, value_type>::for_each(const state_class& s_t,
+        function f) const
+    {
+        auto state = __policies__.find(s_t);
+        if (state == __policies__.end()) return;
+        for (const auto& item : state->second) {
+            f(static_cast<action_class>(item.first), item.second);
+        }
+    }
+
+    template <class state_class,
+        class action_class,
+        typename value_type>
+    template <class function>
+    void map_storage<state_class, action_class, value_type>::for_each(function f) const
+    {
+        for (const auto& s_t : __policies__) {
+            for (const auto& a_t : s_t.second) {
+                f(static_cast<state_class>(s_t.first),
+                    static_cast<action_class>(a_t.first), a_t.second);
+            }
+        }
+    }
+
+    template <class state_class,
+        class action_class,
+        typename value_type>
+    template <class function>
+    bool map_storage<state_class, action_class, value_type>::best(const state_class& s_t,
+        function f) const
+    {
+        auto state = __policies__.find(s_t);
+        if (state == __policies__.end() || state->second.empty()) return false;
+        auto item = state->second.begin();
+        for (auto it = std::next(item); it != state->second.end(); ++it) {
+            if (item->second < it->second) item = it;
+        }
+        f(static_cast<action_class>(item->first), item->second);
+        return true;
+    }
+
+#ifdef USING_BOOST_SERIALIZATION
+    template <class state_class,
+        class action_class,
+        typename value_type>
+    template <typename archive>
+    void map_storage<state_class, action_class, value_type>::serialize(archive& ar,
+        const unsigned int /*version*/)
+    {
+        ar& __policies__;
+    }
+#endif
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    dense_storage<state_class, action_class, indexer, value_type>::dense_storage()
+        : __values__(indexer::state_count * indexer::action_count, unvisited())
+    {}
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    void dense_storage<state_class, action_class, indexer, value_type>::set(const state_class& s_t,
+        const action_class& a_t,
+        value_type q)
+    {
+        __values__[indexer::state_index(s_t) * indexer::action_count
+            + indexer::action_index(a_t)] = q;
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    value_type dense_storage<state_class, action_class, indexer, value_type>::get(const state_class& s_t,
+        const action_class& a_t) const
+    {
+        const value_type q = __values__[indexer::state_index(s_t) * indexer::action_count
+            + indexer::action_index(a_t)];
+        return q != unvisited() ? q : value_type(0);
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    template <class function>
+    void dense_storage<state_class, action_class, indexer, value_type>::for_each(const state_class& s_t,
+        function f) const
+    {
+        const std::size_t offset = indexer::state_index(s_t) * indexer::action_count;
+        for (std::size_t i = 0; i < indexer::action_count; i++) {
+            if (__values__[offset + i] != unvisited()) {
+                f(indexer::action_at(i), __values__[offset + i]);
+            }
+        }
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    template <class function>
+    void dense_storage<state_class, action_class, indexer, value_type>::for_each(function f) const
+    {
+        for (std::size_t s = 0; s < indexer::state_count; s++) {
+            for (std::size_t i = 0; i < indexer::action_count; i++) {
+                const value_type q = __values__[s * indexer::action_count + i];
+                if (q != unvisited()) {
+                    f(indexer::state_at(s), indexer::action_at(i), q);
+                }
+            }
+        }
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    template <class function>
+    bool dense_storage<state_class, action_class, indexer, value_type>::best(const state_class& s_t,
+        function f) const
+    {
+        const value_type* qs = values(s_t);
+        if (!qs) return false;
+        const std::size_t i = argmax<indexer::action_count>(qs);
+        // unvisited is the lowest value, so it is only the highest if no action was set
+        if (qs[i] == unvisited()) return false;
+        f(indexer::action_at(i), qs[i]);
+        return true;
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    const value_type* dense_storage<state_class, action_class, indexer, value_type>::values(const state_class& s_t) const
+    {
+        return __values__.data() + indexer::state_index(s_t) * indexer::action_count;
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    const value_type* dense_storage<state_class, action_class, indexer, value_type>::data() const
+    {
+        return __values__.data();
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    const value_type* dense_storage<state_class, action_class, indexer, value_type>::values_at(std::size_t s) const
+    {
+        return __values__.data() + s * indexer::action_count;
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    value_type dense_storage<state_class, action_class, indexer, value_type>::get_at(std::size_t s,
+        std::size_t a) const
+    {
+        return __values__[s * indexer::action_count + a];
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    void dense_storage<state_class, action_class, indexer, value_type>::set_at(std::size_t s,
+        std::size_t a,
+        value_type q)
+    {
+        __values__[s * indexer::action_count + a] = q;
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    value_type dense_storage<state_class, action_class, indexer, value_type>::unvisited()
+    {
+        // not NaN: text archives can not read NaN back
+        return std::numeric_limits<value_type>::lowest();
+    }
+
+#ifdef USING_BOOST_SERIALIZATION
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    template <typename archive>
+    void dense_storage<state_class, action_class, indexer, value_type>::serialize(archive& ar,
+        const unsigned int /*version*/)
+    {
+        ar& __values__;
+        // an archive of another indexer would silently shift every value
+        if (archive::is_loading::value
+            && __values__.size() != indexer::state_count * indexer::action_count) {
+            throw std::length_error("dense_storage: archive does not hold state_count * action_count values");
+        }
+    }
+#endif
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    void flat_map_storage<state_class, action_class, indexer, value_type>::set(const state_class& s_t,
+        const action_class& a_t,
+        value_type q)
+    {
+        __values__[find_or_insert(s_t)][indexer::action_index(a_t)] = q;
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    value_type flat_map_storage<state_class, action_class, indexer, value_type>::get(const state_class& s_t,
+        const action_class& a_t) const
+    {
+        const std::size_t entry = find(s_t, hash_of(s_t));
+        if (entry == npos) return value_type(0);
+        const value_type q = __values__[entry][indexer::action_index(a_t)];
+        return q != unvisited() ? q : value_type(0);
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    template <class function>
+    void flat_map_storage<state_class, action_class, indexer, value_type>::for_each(const state_class& s_t,
+        function f) const
+    {
+        const std::size_t entry = find(s_t, hash_of(s_t));
+        if (entry == npos) return;
+        for (std::size_t i = 0; i < indexer::action_count; i++) {
+            if (__values__[entry][i] != unvisited()) {
+                f(indexer::action_at(i), __values__[entry][i]);
+            }
+        }
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    template <class function>
+    void flat_map_storage<state_class, action_class, indexer, value_type>::for_each(function f) const
+    {
+        for (std::size_t entry = 0; entry < __states__.size(); entry++) {
+            for (std::size_t i = 0; i < indexer::action_count; i++) {
+                if (__values__[entry][i] != unvisited()) {
+                    f(__states__[entry], indexer::action_at(i), __values__[entry][i]);
+                }
+            }
+        }
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    template <class function>
+    bool flat_map_storage<state_class, action_class, indexer, value_type>::best(const state_class& s_t,
+        function f) const
+    {
+        const value_type* qs = values(s_t);
+        if (!qs) return false;
+        const std::size_t i = argmax<indexer::action_count>(qs);
+        // unvisited is the lowest value, so it is only the highest if no action was set
+        if (qs[i] == unvisited()) return false;
+        f(indexer::action_at(i), qs[i]);
+        return true;
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    const value_type* flat_map_storage<state_class, action_class, indexer, value_type>::values(const state_class& s_t) const
+    {
+        const std::size_t entry = find(s_t, hash_of(s_t));
+        return entry != npos ? __values__[entry].data() : nullptr;
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    std::size_t flat_map_storage<state_class, action_class, indexer, value_type>::size() const
+    {
+        return __states__.size();
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    value_type flat_map_storage<state_class, action_class, indexer, value_type>::unvisited()
+    {
+        // not NaN: text archives can not read NaN back
+        return std::numeric_limits<value_type>::lowest();
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    std::size_t flat_map_storage<state_class, action_class, indexer, value_type>::find(const state_class& s_t,
+        std::uint32_t hash) const
+    {
+        if (__buckets__.empty()) return npos;
+        const std::size_t mask = __buckets__.size() - 1;
+        // Robin Hood: once a bucket is closer to its own slot than `s_t` would be, `s_t` is not in the table
+        for (std::size_t slot = hash & mask, distance = 0;; slot = (slot + 1) & mask, distance++) {
+            const bucket& b = __buckets__[slot];
+            if (b.hash == 0 || ((slot - (b.hash & mask)) & mask) < distance) return npos;
+            if (b.hash == hash && __states__[b.entry] == s_t) return b.entry;
+        }
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    std::size_t flat_map_storage<state_class, action_class, indexer, value_type>::find_or_insert(const state_class& s_t)
+    {
+        const std::uint32_t hash = hash_of(s_t);
+        const std::size_t entry = find(s_t, hash);
+        if (entry != npos) return entry;
+        // grow at 7/8 load, Robin Hood keeps the probe sequences short
+        if ((__states__.size() + 1) * 8 > __buckets__.size() * 7) grow();
+        __states__.push_back(s_t);
+        values_type values;
+        values.fill(unvisited());
+        __values__.push_back(values);
+        insert_bucket(bucket{ hash, static_cast<std::uint32_t>(__states__.size() - 1) });
+        return __states__.size() - 1;
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    void flat_map_storage<state_class, action_class, indexer, value_type>::insert_bucket(bucket arg)
+    {
+        const std::size_t mask = __buckets__.size() - 1;
+        for (std::size_t slot = arg.hash & mask, distance = 0;; slot = (slot + 1) & mask, distance++) {
+            bucket& b = __buckets__[slot];
+            if (b.hash == 0) {
+                b = arg;
+                return;
+            }
+            const std::size_t b_distance = (slot - (b.hash & mask)) & mask;
+            if (b_distance < distance) {
+                std::swap(b, arg);
+                distance = b_distance;
+            }
+        }
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    void flat_map_storage<state_class, action_class, indexer, value_type>::grow()
+    {
+        std::vector<bucket> old(__buckets__.empty() ? 16 : __buckets__.size() * 2, bucket{ 0, 0 });
+        old.swap(__buckets__);
+        for (const bucket& b : old) {
+            if (b.hash != 0) insert_bucket(b);
+        }
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    std::uint32_t flat_map_storage<state_class, action_class, indexer, value_type>::hash_of(const state_class& s_t)
+    {
+        // std::hash of integers is often the identity, so the bits are mixed before using the low ones as slot
+        const std::uint64_t hash = static_cast<std::uint64_t>(hasher<state_class>{}(s_t)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<std::uint32_t>(hash >> 32) | 0x80000000u;
+    }
+
+#ifdef USING_BOOST_SERIALIZATION
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    template <typename archive>
+    void flat_map_storage<state_class, action_class, indexer, value_type>::serialize(archive& ar,
+        const unsigned int version)
+    {
+        boost::serialization::split_member(ar, *this, version);
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    template <typename archive>
+    void flat_map_storage<state_class, action_class, indexer, value_type>::save(archive& ar,
+        const unsigned int version) const
+    {
+        std::size_t count = __states__.size();
+        ar& count;
+        for (std::size_t entry = 0; entry < count; entry++) {
+            state_serial<state_class> s_t(__states__[entry]);
+            ar& s_t;
+            for (value_type q : __values__[entry]) {
+                ar& q;
+            }
+        }
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    template <typename archive>
+    void flat_map_storage<state_class, action_class, indexer, value_type>::load(archive& ar,
+        const unsigned int version)
+    {
+        std::size_t count = 0;
+        ar& count;
+        for (std::size_t entry = 0; entry < count; entry++) {
+            state_serial<state_class> s_t;
+            ar& s_t;
+            values_type& values = __values__[find_or_insert(s_t)];
+            for (value_type& q : values) {
+                ar& q;
+            }
+        }
+    }
+#endif
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    dense_view_storage<state_class, action_class, indexer, value_type>::dense_view_storage(const value_type* values)
+        : __values__(values)
+    {}
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    value_type dense_view_storage<state_class, action_class, indexer, value_type>::get(const state_class& s_t,
+        const action_class& a_t) const
+    {
+        const value_type q = __values__[indexer::state_index(s_t) * indexer::action_count
+            + indexer::action_index(a_t)];
+        return q != unvisited() ? q : value_type(0);
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    template <class function>
+    void dense_view_storage<state_class, action_class, indexer, value_type>::for_each(const state_class& s_t,
+        function f) const
+    {
+        const value_type* qs = values(s_t);
+        for (std::size_t i = 0; i < indexer::action_count; i++) {
+            if (qs[i] != unvisited()) {
+                f(indexer::action_at(i), qs[i]);
+            }
+        }
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    template <class function>
+    void dense_view_storage<state_class, action_class, indexer, value_type>::for_each(function f) const
+    {
+        for (std::size_t s = 0; s < indexer::state_count; s++) {
+            for (std::size_t i = 0; i < indexer::action_count; i++) {
+                const value_type q = __values__[s * indexer::action_count + i];
+                if (q != unvisited()) {
+                    f(indexer::state_at(s), indexer::action_at(i), q);
+                }
+            }
+        }
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    template <class function>
+    bool dense_view_storage<state_class, action_class, indexer, value_type>::best(const state_class& s_t,
+        function f) const
+    {
+        const value_type* qs = values(s_t);
+        const std::size_t i = argmax<indexer::action_count>(qs);
+        if (qs[i] == unvisited()) return false;
+        f(indexer::action_at(i), qs[i]);
+        return true;
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    const value_type* dense_view_storage<state_class, action_class, indexer, value_type>::values(const state_class& s_t) const
+    {
+        return values_at(indexer::state_index(s_t));
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    const value_type* dense_view_storage<state_class, action_class, indexer, value_type>::values_at(std::size_t s) const
+    {
+        return __values__ + s * indexer::action_count;
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    value_type dense_view_storage<state_class, action_class, indexer, value_type>::get_at(std::size_t s,
+        std::size_t a) const
+    {
+        return __values__[s * indexer::action_count + a];
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    value_type dense_view_storage<state_class, action_class, indexer, value_type>::unvisited()
+    {
+        return dense_storage<state_class, action_class, indexer, value_type>::unvisited();
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    atomic_dense_storage<state_class, action_class, indexer, value_type>::atomic_dense_storage()
+        : __values__(new std::atomic<value_type>[indexer::state_count * indexer::action_count])
+    {
+        for (std::size_t i = 0; i < indexer::state_count * indexer::action_count; i++) {
+            __values__[i].store(unvisited(), std::memory_order_relaxed);
+        }
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    atomic_dense_storage<state_class, action_class, indexer, value_type>::atomic_dense_storage(const value_type* values)
+        : __values__(new std::atomic<value_type>[indexer::state_count * indexer::action_count])
+    {
+        for (std::size_t i = 0; i < indexer::state_count * indexer::action_count; i++) {
+            __values__[i].store(values[i], std::memory_order_relaxed);
+        }
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    void atomic_dense_storage<state_class, action_class, indexer, value_type>::set(const state_class& s_t,
+        const action_class& a_t,
+        value_type q)
+    {
+        set_at(indexer::state_index(s_t), indexer::action_index(a_t), q);
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    value_type atomic_dense_storage<state_class, action_class, indexer, value_type>::get(const state_class& s_t,
+        const action_class& a_t) const
+    {
+        const value_type q = get_at(indexer::state_index(s_t), indexer::action_index(a_t));
+        return q != unvisited() ? q : value_type(0);
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    template <class function>
+    void atomic_dense_storage<state_class, action_class, indexer, value_type>::for_each(const state_class& s_t,
+        function f) const
+    {
+        const values_type qs = values_at(indexer::state_index(s_t));
+        for (std::size_t i = 0; i < indexer::action_count; i++) {
+            if (qs[i] != unvisited()) {
+                f(indexer::action_at(i), qs[i]);
+            }
+        }
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    template <class function>
+    void atomic_dense_storage<state_class, action_class, indexer, value_type>::for_each(function f) const
+    {
+        for (std::size_t s = 0; s < indexer::state_count; s++) {
+            for (std::size_t i = 0; i < indexer::action_count; i++) {
+                const value_type q = get_at(s, i);
+                if (q != unvisited()) {
+                    f(indexer::state_at(s), indexer::action_at(i), q);
+                }
+            }
+        }
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    template <class function>
+    bool atomic_dense_storage<state_class, action_class, indexer, value_type>::best(const state_class& s_t,
+        function f) const
+    {
+        const values_type qs = values_at(indexer::state_index(s_t));
+        const std::size_t i = argmax<indexer::action_count>(qs.data());
+        if (qs[i] == unvisited()) return false;
+        f(indexer::action_at(i), qs[i]);
+        return true;
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    void atomic_dense_storage<state_class, action_class, indexer, value_type>::copy(value_type* values) const
+    {
+        for (std::size_t i = 0; i < indexer::state_count * indexer::action_count; i++) {
+            values[i] = __values__[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    typename atomic_dense_storage<state_class, action_class, indexer, value_type>::values_type
+        atomic_dense_storage<state_class, action_class, indexer, value_type>::values_at(std::size_t s) const
+    {
+        values_type qs;
+        for (std::size_t i = 0; i < indexer::action_count; i++) {
+            qs[i] = get_at(s, i);
+        }
+        return qs;
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    value_type atomic_dense_storage<state_class, action_class, indexer, value_type>::get_at(std::size_t s,
+        std::size_t a) const
+    {
+        return __values__[s * indexer::action_count + a].load(std::memory_order_relaxed);
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    void atomic_dense_storage<state_class, action_class, indexer, value_type>::set_at(std::size_t s,
+        std::size_t a,
+        value_type q)
+    {
+        __values__[s * indexer::action_count + a].store(q, std::memory_order_relaxed);
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer,
+        typename value_type>
+    value_type atomic_dense_storage<state_class, action_class, indexer, value_type>::unvisited()
+    {
+        return dense_storage<state_class, action_class, indexer, value_type>::unvisited();
+    }
+
+    template <class state_class,
+        class action_class,
+        typename value_type,
+        class storage_class>
+    policy<state_class, action_class, value_type, storage_class>::policy(storage_class storage)
+        : __storage__(std::move(storage))
+    {}
+
+    template <class state_class,
+        class action_class,
+        typename value_type,
+        class storage_class>
+    typename policy<state_class, action_class, value_type, storage_class>::action_map
+        policy<state_class, action_class, value_type, storage_class>::actions(const state_class& s_t) const
+    {
+        action_map retval;
+        __storage__.for_each(s_t, [&](const action_class& a_t, value_type q) {
+            retval.emplace(a_t, q);
+        });
+        return retval;
+    }
+
+    template <class state_class,
+        class action_class,
+        typename value_type,
+        class storage_class>
+    void policy<state_class, action_class, value_type, storage_class>::update(const state_class& s_t,
+        const action_class& a_t,
+        value_type q)
+    {
+        __storage__.set(s_t, a_t, q);
+    }
+
+    template <class state_class,
+        class action_class,
+        typename value_type,
+        class storage_class>
+    value_type policy<state_class, action_class, value_type, storage_class>::value(const state_class& s_t,
+        const action_class& a_t) const
+    {
+        return __storage__.get(s_t, a_t);
+    }
+
+    template <class state_class,
+        class action_class,
+        typename value_type,
+        class storage_class>
+    value_type policy<state_class, action_class, value_type, storage_class>::best_value(const state_class& s_t) const
+    {
+        value_type retval = std::numeric_limits<value_type>::quiet_NaN();
+        __storage__.best(s_t, [&](const action_class&, value_type q) {
+            retval = q;
+        });
+        return retval;
+    }
+
+    template <class state_class,
+        class action_class,
+        typename value_type,
+        class storage_class>
+    std::unique_ptr<action_class>
+        policy<state_class, action_class, value_type, storage_class>::best_action(const state_class& s_t) const
+    {
+        return std::move(best(s_t).first);
     }
 
-    template <class state_trait,
-        typename value_type>
-    void state<state_trait, value_type>::set_reward(value_type reward)
+    template <class state_class,
+        class action_class,
+        typename value_type,
+        class storage_class>
+    std::pair<std::unique_ptr<action_class>, value_type>
+        policy<state_class, action_class, value_type, storage_class>::best(const state_class& s_t) const
     {
-        __reward__ = reward;
+        std::pair<std::unique_ptr<action_class>, value_type> retval(nullptr,
+            std::numeric_limits<value_type>::quiet_NaN());
+        __storage__.best(s_t, [&](const action_class& a_t, value_type q) {
+            retval.first = std::make_unique<action_class>(a_t);
+            retval.second = q;
+        });
+        return retval;
     }
 
-    template <class state_trait,
-        typename value_type>
-    bool state<state_trait, value_type>::operator==(const state<state_trait>& arg) const
+    template <class state_class,
+        class action_class,
+        typename value_type,
+        class storage_class>
+    const storage_class& policy<state_class, action_class, value_type, storage_class>::storage() const
     {
-        return (this->__trait__ == arg.__trait__);
+        return __storage__;
     }
 
-    template <class state_trait,
-        typename value_type>
-    bool state<state_trait, value_type>::operator<(const state<state_trait>& arg) const
+    template <class state_class,
+        class action_class,
+        typename value_type,
+        class storage_class>
+    value_type policy<state_class, action_class, value_type, storage_class>::value_at(std::size_t s,
+        std::size_t a) const
     {
-        return (this->__trait__ < arg.__trait__);
+        const value_type q = __storage__.get_at(s, a);
+        return q != storage_class::unvisited() ? q : value_type(0);
     }
 
-    template <class state_trait,
-        typename value_type>
-    std::size_t state<state_trait, value_type>::hash() const
+    template <class state_class,
+        class action_class,
+        typename value_type,
+        class storage_class>
+    value_type policy<state_class, action_class, value_type, storage_class>::best_value_at(std::size_t s) const
     {
-        return std::hash<state_trait>{}(__trait__);
+        // a pointer, or a copy for storages that other threads update (@see `atomic_dense_storage`)
+        const auto qs = __storage__.values_at(s);
+        const value_type q = qs[argmax<storage_class::action_count>(&qs[0])];
+        return q != storage_class::unvisited() ? q : std::numeric_limits<value_type>::quiet_NaN();
     }
 
-    template <class state_trait,
-        typename value_type>
-    state_trait state<state_trait, value_type>::trait() const
+    template <class state_class,
+        class action_class,
+        typename value_type,
+        class storage_class>
+    void policy<state_class, action_class, value_type, storage_class>::update_at(std::size_t s,
+        std::size_t a,
+        value_type q)
     {
-        return __trait__;
+        __storage__.set_at(s, a, q);
     }
 
 #ifdef USING_BOOST_SERIALIZATION
-    template <class state_trait,
-        typename value_type>
+    template <class state_class,
+        class action_class,
+        typename value_type,
+        class storage_class>
     template <typename archive>
-    void state<state_trait, value_type>::serialize(archive& ar,
+    void policy<state_class, action_class, value_type, storage_class>::serialize(archive& ar,
         const unsigned int version)
     {
-        ar& __trait__;
-        ar& __reward__;
+        __storage__.serialize(ar, version);
     }
-#endif
 
-    template <class action_trait>
-    action<action_trait>::action(action_trait trait)
-        : __trait__(trait)
-    {}
+    template <class state_class>
+    std::size_t hasher<state_serial<state_class>
+    >::operator()(const state_serial<state_class>& arg) const
+    {
+        return arg.hash();
+    }
 
-    template <class action_trait>
-    std::size_t action<action_trait>::hash() const
+    template <class action_class>
+    std::size_t hasher<action_serial<action_class>
+    >::operator()(const action_serial<action_class>& arg) const
     {
-        return std::hash<action_trait>{}(__trait__);
+        return arg.hash();
     }
+#endif
 
-    template <class action_trait>
-    bool action<action_trait>::operator==(const action<action_trait>& arg) const
+    template <class state_class,
+        class action_class,
+        typename value_type,
+        class storage_class>
+    void policy<state_class, action_class, value_type, storage_class>::operator+=(const policy& arg)
     {
-        return (this->__trait__ == arg.__trait__);
+        arg.__storage__.for_each([&](const state_class& s_t, const action_class& a_t, value_type q) {
+            __storage__.set(s_t, a_t, q);
+        });
     }
 
-    template <class action_trait>
-    bool action<action_trait>::operator<(const action<action_trait>& arg) const
+    template <class state_class,
+        class action_class>
+    bool map_model<state_class, action_class>::key::operator==(const key& arg) const
     {
-        return (this->__trait__ < arg.__trait__);
+        return state == arg.state && action == arg.action;
     }
 
-    template <class action_trait>
-    action_trait action<action_trait>::trait() const
+    template <class state_class,
+        class action_class>
+    std::size_t map_model<state_class, action_class>::key_hasher::operator()(const key& arg) const
     {
-        return __trait__;
+        std::size_t seed = hasher<state_class>()(arg.state);
+        hash_combine(seed, hasher<action_class>()(arg.action));
+        return seed;
     }
 
-#ifdef USING_BOOST_SERIALIZATION
-    template <class action_trait>
-    template <typename archive>
-    void action<action_trait>::serialize(archive& ar,
-        const unsigned int version)
+    template <class state_class,
+        class action_class>
+    void map_model<state_class, action_class>::observe(const state_class& s_t,
+        const action_class& a_t,
+        const state_class& s_next)
     {
-        ar& __trait__;
+        successors& observed = __pairs__[key{ s_t, a_t }];
+        observed.total++;
+        for (auto& count : observed.counts) {
+            if (count.first == s_next) {
+                count.second++;
+                return;
+            }
+        }
+        observed.counts.emplace_back(s_next, 1);
     }
-#endif
 
     template <class state_class,
         class action_class>
-    bool link<state_class, action_class>::operator<(const link<state_class,
-        action_class>& arg) const
+    double map_model<state_class, action_class>::probability(const state_class& s_t,
+        const action_class& a_t,
+        const state_class& s_next) const
     {
-        return (this->action < arg.action) &&
-            (this->state < arg.state);
+        auto observed = __pairs__.find(key{ s_t, a_t });
+        if (observed == __pairs__.end()) return 0;
+        for (const auto& count : observed->second.counts) {
+            if (count.first == s_next) {
+                return static_cast<double>(count.second) / observed->second.total;
+            }
+        }
+        return 0;
     }
 
     template <class state_class,
         class action_class>
-    bool link<state_class, action_class>::operator==(const link<state_class,
-        action_class>& arg) const
+    std::size_t map_model<state_class, action_class>::size() const
     {
-        return (this->action == arg.action) &&
-            (this->state == arg.state);
+        return __pairs__.size();
     }
 
     template <class state_class,
         class action_class,
-        typename value_type>
-    typename policy<state_class, action_class, value_type>::action_map
-        policy<state_class, action_class, value_type>::actions(state_class s_t)
+        class indexer>
+    dense_model<state_class, action_class, indexer>::dense_model()
+        : __next__(indexer::state_count * indexer::action_count, unobserved()),
+        __counts__(indexer::state_count * indexer::action_count, 0)
+    {}
+
+    template <class state_class,
+        class action_class,
+        class indexer>
+    void dense_model<state_class, action_class, indexer>::observe(const state_class& s_t,
+        const action_class& a_t,
+        const state_class& s_next)
     {
-#ifdef USING_BOOST_SERIALIZATION
-        std::unordered_map<action_class, value_type, hasher<action_class>> retval;
-        for (const auto& item : __policies__[s_t]) {
-            retval[static_cast<action_class>(item.first)] = item.second;
+        const std::size_t i = indexer::state_index(s_t) * indexer::action_count + indexer::action_index(a_t);
+        const std::uint32_t next = static_cast<std::uint32_t>(indexer::state_index(s_next));
+        if (__next__[i] == unobserved() || __next__[i] == next) {
+            __next__[i] = next;
+            __counts__[i]++;
+            return;
         }
-        return retval;
-#else
-        return __policies__[s_t];
-#endif
+        auto& others = __others__[i];
+        for (auto& count : others) {
+            if (count.first == next) {
+                count.second++;
+                return;
+            }
+        }
+        others.emplace_back(next, 1);
     }
 
     template <class state_class,
         class action_class,
-        typename value_type>
-    void policy<state_class, action_class, value_type>::update(state_class s_t,
-        action_class a_t,
-        value_type q)
+        class indexer>
+    double dense_model<state_class, action_class, indexer>::probability(const state_class& s_t,
+        const action_class& a_t,
+        const state_class& s_next) const
     {
-        __policies__[s_t][a_t] = q;
+        const std::size_t i = indexer::state_index(s_t) * indexer::action_count + indexer::action_index(a_t);
+        if (__counts__[i] == 0) return 0;
+        const std::uint32_t next = static_cast<std::uint32_t>(indexer::state_index(s_next));
+        std::uint32_t count = __next__[i] == next ? __counts__[i] : 0;
+        std::uint64_t total = __counts__[i];
+        if (!__others__.empty()) {
+            auto others = __others__.find(i);
+            if (others != __others__.end()) {
+                for (const auto& other : others->second) {
+                    count += other.first == next ? other.second : 0;
+                    total += other.second;
+                }
+            }
+        }
+        return static_cast<double>(count) / total;
     }
 
     template <class state_class,
         class action_class,
-        typename value_type>
-    value_type policy<state_class, action_class, value_type>::value(state_class s_t,
-        action_class a_t)
+        class indexer>
+    std::uint32_t dense_model<state_class, action_class, indexer>::unobserved()
+    {
+        return static_cast<std::uint32_t>(-1);
+    }
+
+    template <class state_class,
+        class action_class,
+        class indexer>
+    std::size_t dense_model<state_class, action_class, indexer>::memory() const
     {
-        return __policies__[s_t][a_t];
+        std::size_t others = __others__.bucket_count() * sizeof(void*);
+        for (const auto& pair : __others__) {
+            others += sizeof(pair) + 2 * sizeof(void*)
+                + pair.second.capacity() * sizeof(std::pair<std::uint32_t, std::uint32_t>);
+        }
+        return (__next__.capacity() + __counts__.capacity()) * sizeof(std::uint32_t) + others;
     }
 
     template <class state_class,
         class action_class,
+        typename markov_chain,
         typename value_type>
-    value_type policy<state_class, action_class, value_type>::best_value(state_class s_t)
+    template <class policy_class>
+    typename q_learning<state_class, action_class, markov_chain, value_type>::triplet
+        q_learning<state_class, action_class, markov_chain, value_type
+        >::q_value(const markov_chain& episode,
+            unsigned int index,
+            policy_class& policy_map)
     {
-        auto it = std::max_element(__policies__[s_t].begin(),
-            __policies__[s_t].end(),
-            [&](const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; });
-        return it != __policies__[s_t].end() ? it->second :
-            std::numeric_limits<value_type>::quiet_NaN();
+        const auto& step = episode[index];
+        if (index < episode.size() - 1) {
+            auto q = policy_map.value(step.state, step.action);
+            const auto& next = episode[index + 1];
+            auto q_next = policy_map.best_value(next.state);
+            auto r = step.state.reward();
+            if (std::isnan(q_next)) q_next = 0.;
+            return std::make_tuple(step.state, step.action,
+                q + alpha * (r + (gamma * q_next) - q));
+        }
+        else {
+            return std::make_tuple(step.state, step.action, step.state.reward());
+        }
     }
 
     template <class state_class,
         class action_class,
+        typename markov_chain,
         typename value_type>
-    std::unique_ptr<action_class>
-        policy<state_class, action_class, value_type>::best_action(state_class s_t)
+    template <class policy_class>
+    void q_learning<state_class, action_class, markov_chain, value_type
+    >::operator()(const markov_chain& episode,
+        policy_class& policy_map)
     {
-        auto it = std::max_element(__policies__[s_t].begin(),
-            __policies__[s_t].end(),
-            [&](const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; });
-        return it != __policies__[s_t].end() ?
-            std::move(std::make_unique<action_class>(it->first)) : nullptr;
+        (*this)(episode.begin(), episode.end(), policy_map);
     }
 
     template <class state_class,
         class action_class,
+        typename markov_chain,
         typename value_type>
-    std::pair<std::unique_ptr<action_class>, value_type>
-        policy<state_class, action_class, value_type>::best(state_class s_t)
+    template <class iterator,
+        class policy_class>
+    void q_learning<state_class, action_class, markov_chain, value_type
+    >::operator()(iterator first,
+        iterator last,
+        policy_class& policy_map)
     {
-        auto it = std::max_element(__policies__[s_t].begin(),
-            __policies__[s_t].end(),
-            [&](const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; });
-        return it != __policies__[s_t].end() ?
-            std::make_pair(std::make_unique<action_class>(it->first), it->second) :
-            std::make_pair(nullptr, std::numeric_limits<value_type>::quiet_NaN());
+        // the same rule as `q_value`, without copying the links into a triplet
+        for (iterator it = first; it != last; ++it) {
+            const auto& step = *it;
+            const iterator next = std::next(it);
+            if (next != last) {
+                auto q = policy_map.value(step.state, step.action);
+                auto q_next = policy_map.best_value(next->state);
+                auto r = step.state.reward();
+                if (std::isnan(q_next)) q_next = 0.;
+                policy_map.update(step.state, step.action,
+                    q + alpha * (r + (gamma * q_next) - q));
+            }
+            else {
+                policy_map.update(step.state, step.action, step.state.reward());
+            }
+        }
     }
 
-#ifdef USING_BOOST_SERIALIZATION
     template <class state_class,
         class action_class,
+        typename markov_chain,
         typename value_type>
-    template <typename archive>
-    void policy<state_class, action_class, value_type>::serialize(archive& ar,
-        const unsigned int version)
+    template <class policy_class,
+        typename reward_type>
+    void q_learning<state_class, action_class, markov_chain, value_type
+    >::operator()(const compact_episode<reward_type>& episode,
+        policy_class& policy_map)
     {
-        ar& __policies__;
+        // the same rule as `q_value`
+        for (std::size_t i = 0; i < episode.size(); i++) {
+            const compact_link<reward_type>& step = episode[i];
+            if (i < episode.size() - 1) {
+                value_type q = policy_map.value_at(step.state, step.action);
+                value_type q_next = policy_map.best_value_at(episode[i + 1].state);
+                if (std::isnan(q_next)) q_next = 0.;
+                policy_map.update_at(step.state, step.action,
+                    q + alpha * (step.reward + (gamma * q_next) - q));
+            }
+            else {
+                policy_map.update_at(step.state, step.action, step.reward);
+            }
+        }
     }
 
-    template <class state_class>
-    std::size_t hasher<state_serial<state_class>
-    >::operator()(const state_serial<state_class>& arg) const
+    template <class state_class,
+        class action_class,
+        typename markov_chain,
+        typename value_type>
+    template <class policy_class>
+    value_type q_learning<state_class, action_class, markov_chain, value_type
+    >::operator()(const transition<link<state_class, action_class>>& arg,
+        policy_class& policy_map)
     {
-        return arg.hash();
+        // the same rule as `q_value`
+        const value_type q = policy_map.value(arg.step.state, arg.step.action);
+        if (arg.last) {
+            const value_type r = arg.step.state.reward();
+            policy_map.update(arg.step.state, arg.step.action, r);
+            return r - q;
+        }
+        value_type q_next = policy_map.best_value(arg.next.state);
+        if (std::isnan(q_next)) q_next = 0.;
+        const value_type target = arg.step.state.reward() + gamma * q_next;
+        policy_map.update(arg.step.state, arg.step.action, q + alpha * (target - q));
+        return target - q;
     }
 
-    template <class action_class>
-    std::size_t hasher<action_serial<action_class>
-    >::operator()(const action_serial<action_class>& arg) const
+    template <class state_class,
+        class action_class,
+        typename markov_chain,
+        typename value_type>
+    template <class policy_class,
+        typename reward_type>
+    value_type q_learning<state_class, action_class, markov_chain, value_type
+    >::operator()(const transition<compact_link<reward_type>>& arg,
+        policy_class& policy_map)
     {
-        return arg.hash();
+        const value_type q = policy_map.value_at(arg.step.state, arg.step.action);
+        if (arg.last) {
+            policy_map.update_at(arg.step.state, arg.step.action, arg.step.reward);
+            return arg.step.reward - q;
+        }
+        value_type q_next = policy_map.best_value_at(arg.next.state);
+        if (std::isnan(q_next)) q_next = 0.;
+        const value_type target = arg.step.reward + gamma * q_next;
+        policy_map.update_at(arg.step.state, arg.step.action, q + alpha * (target - q));
+        return target - q;
     }
-#endif
 
     template <class state_class,
         class action_class,
+        typename markov_chain,
         typename value_type>
-    void policy<state_class, action_class, value_type>::operator+=(const policy& arg)
+    template <class policy_class,
+        typename reward_type>
+    void q_learning<state_class, action_class, markov_chain, value_type
+    >::operator()(const transition_table<reward_type>& table,
+        policy_class& policy_map)
     {
-#ifdef USING_BOOST_SERIALIZATION
-        for (const auto& s_t : arg.__policies__) {
-            for (const auto& a_t : s_t.second) {
-                __policies__[static_cast<state_class>(s_t.first)]
-                    [static_cast<action_class>(a_t.first)] = a_t.second;
+        table.for_each_pair([&](const transition_count<reward_type>* first,
+            const transition_count<reward_type>* last) {
+            value_type target = 0;
+            std::uint64_t count = 0;
+            bool terminal = true;
+            for (const transition_count<reward_type>* it = first; it != last; ++it) {
+                value_type g = it->reward;
+                if (!it->last) {
+                    value_type q_next = policy_map.best_value_at(it->next);
+                    if (std::isnan(q_next)) q_next = 0.;
+                    g += gamma * q_next;
+                    terminal = false;
+                }
+                target += g * it->count;
+                count += it->count;
             }
-        }
-#else
-        for (const auto& s_t : arg.__policies__) {
-            for (const auto& a_t : s_t.second) {
-                __policies__[s_t][a_t] = a_t.second;
+            target /= count;
+            if (terminal) {
+                policy_map.update_at(first->state, first->action, target);
             }
-        }
-#endif
+            else {
+                const value_type q = policy_map.value_at(first->state, first->action);
+                policy_map.update_at(first->state, first->action, q + alpha * (target - q));
+            }
+        });
     }
 
     template <class state_class,
         class action_class,
         typename markov_chain,
         typename value_type>
-    typename q_learning<state_class, action_class, markov_chain, value_type>::triplet
-        q_learning<state_class, action_class, markov_chain, value_type
-        >::q_value(markov_chain& episode,
-            unsigned int index,
-            policy<state_class, action_class>& policy_map)
+    template <class policy_class>
+    void q_lambda<state_class, action_class, markov_chain, value_type
+    >::operator()(const markov_chain& episode,
+        policy_class& policy_map)
     {
-        auto step = episode[index];
-        if (index < episode.size() - 1) {
-            auto q = policy_map.value(step.state, step.action);
-            auto next = episode[index + 1];
-            auto q_next = policy_map.best_value(next.state);
-            auto r = step.state.reward();
+        (*this)(episode.begin(), episode.end(), policy_map);
+    }
+
+    template <class state_class,
+        class action_class,
+        typename markov_chain,
+        typename value_type>
+    template <class iterator,
+        class policy_class>
+    void q_lambda<state_class, action_class, markov_chain, value_type
+    >::operator()(iterator first,
+        iterator last,
+        policy_class& policy_map)
+    {
+        if (first == last) return;
+        iterator it = std::prev(last);
+        // the last step has no next state
+        value_type g = it->state.reward();
+        policy_map.update(it->state, it->action, g);
+        while (it != first) {
+            const iterator next = it--;
+            value_type q_next = policy_map.best_value(next->state);
             if (std::isnan(q_next)) q_next = 0.;
-            return std::make_tuple(step.state, step.action,
-                q + alpha * (r + (gamma * q_next) - q));
-        }
-        else {
-            return std::make_tuple(step.state, step.action, step.state.reward());
+            g = it->state.reward() + gamma * ((1 - lambda) * q_next + lambda * g);
+            const value_type q = policy_map.value(it->state, it->action);
+            policy_map.update(it->state, it->action, q + alpha * (g - q));
         }
     }
 
@@ -682,24 +2979,34 @@ namespace relearn
         class action_class,
         typename markov_chain,
         typename value_type>
-    void q_learning<state_class, action_class, markov_chain, value_type
-    >::operator()(markov_chain episode,
-        policy<state_class, action_class>& policy_map)
+    template <class policy_class,
+        typename reward_type>
+    void q_lambda<state_class, action_class, markov_chain, value_type
+    >::operator()(const compact_episode<reward_type>& episode,
+        policy_class& policy_map)
     {
-        // @NOTE - maybe replace index with an STL iterator?
-        for (unsigned int i = 0; i < episode.size(); i++) {
-            auto triplet = q_value(episode, i, policy_map);
-            policy_map.update(std::get<0>(triplet),
-                std::get<1>(triplet),
-                std::get<2>(triplet));
+        // the same rule as above
+        if (episode.size() == 0) return;
+        std::size_t i = episode.size() - 1;
+        value_type g = episode[i].reward;
+        policy_map.update_at(episode[i].state, episode[i].action, g);
+        while (i > 0) {
+            const compact_link<reward_type>& next = episode[i--];
+            const compact_link<reward_type>& step = episode[i];
+            value_type q_next = policy_map.best_value_at(next.state);
+            if (std::isnan(q_next)) q_next = 0.;
+            g = step.reward + gamma * ((1 - lambda) * q_next + lambda * g);
+            const value_type q = policy_map.value_at(step.state, step.action);
+            policy_map.update_at(step.state, step.action, q + alpha * (g - q));
         }
     }
 
     template <class state_class,
         class action_class,
         typename markov_chain,
-        typename value_type>
-    q_probabilistic<state_class, action_class, markov_chain, value_type
+        typename value_type,
+        class model_class>
+    q_probabilistic<state_class, action_class, markov_chain, value_type, model_class
     >::q_probabilistic(value_type discount)
         : gamma(discount)
     {}
@@ -707,26 +3014,19 @@ namespace relearn
     template <class state_class,
         class action_class,
         typename markov_chain,
-        typename value_type>
-    typename q_probabilistic<state_class, action_class, markov_chain, value_type>::triplet
-        q_probabilistic<state_class, action_class, markov_chain, value_type
-        >::q_value(markov_chain& episode,
+        typename value_type,
+        class model_class>
+    template <class policy_class>
+    typename q_probabilistic<state_class, action_class, markov_chain, value_type, model_class>::triplet
+        q_probabilistic<state_class, action_class, markov_chain, value_type, model_class
+        >::q_value(const markov_chain& episode,
             unsigned int index,
-            policy<state_class, action_class>& policy_map)
+            policy_class& policy_map)
     {
-        auto step = episode[index];
+        const auto& step = episode[index];
         if (index < episode.size() - 1) {
-            auto next = episode[index + 1];
-            auto q_next = policy_map.best_value(next.state);
-            auto r = step.state.reward();
-            if (std::isnan(q_next)) q_next = 0.;
-            // transition probability (frequency of transition / total observations)
-            value_type prob = (__memory__[step.state][step.action][next.state]) /
-                (__memory__[step.state][step.action].size());
-            // expected reward
-            value_type r_expected = prob * r;
             return std::make_tuple(step.state, step.action,
-                r_expected + (gamma * (q_next * prob)));
+                q_value(step, episode[index + 1], policy_map));
         }
         else {
             return std::make_tuple(step.state, step.action, step.state.reward());
@@ -736,21 +3036,139 @@ namespace relearn
     template <class state_class,
         class action_class,
         typename markov_chain,
-        typename value_type>
-    void q_probabilistic<state_class, action_class, markov_chain, value_type
-    >::operator()(markov_chain episode,
-        policy<state_class, action_class>& policy_map)
+        typename value_type,
+        class model_class>
+    template <class link_class,
+        class policy_class>
+    value_type q_probabilistic<state_class, action_class, markov_chain, value_type, model_class
+    >::q_value(const link_class& step,
+        const link_class& next,
+        policy_class& policy_map)
+    {
+        auto q_next = policy_map.best_value(next.state);
+        auto r = step.state.reward();
+        if (std::isnan(q_next)) q_next = 0.;
+        // transition probability (frequency of transition / total observations)
+        value_type prob = static_cast<value_type>(__memory__.probability(step.state, step.action, next.state));
+        // expected reward
+        value_type r_expected = prob * r;
+        return r_expected + (gamma * (q_next * prob));
+    }
+
+    template <class state_class,
+        class action_class,
+        typename markov_chain,
+        typename value_type,
+        class model_class>
+    template <class policy_class>
+    void q_probabilistic<state_class, action_class, markov_chain, value_type, model_class
+    >::operator()(const markov_chain& episode,
+        policy_class& policy_map)
+    {
+        (*this)(episode.begin(), episode.end(), policy_map);
+    }
+
+    template <class state_class,
+        class action_class,
+        typename markov_chain,
+        typename value_type,
+        class model_class>
+    template <class iterator,
+        class policy_class>
+    void q_probabilistic<state_class, action_class, markov_chain, value_type, model_class
+    >::operator()(iterator first,
+        iterator last,
+        policy_class& policy_map)
+    {
+        for (iterator it = first; it != last && std::next(it) != last; ++it) {
+            __memory__.observe(it->state, it->action, std::next(it)->state);
+        }
+        for (iterator it = first; it != last; ++it) {
+            const iterator next = std::next(it);
+            if (next != last) {
+                policy_map.update(it->state, it->action, q_value(*it, *next, policy_map));
+            }
+            else {
+                policy_map.update(it->state, it->action, it->state.reward());
+            }
+        }
+    }
+
+    template <class state_class,
+        class action_class,
+        typename markov_chain,
+        typename value_type,
+        class model_class>
+    void q_probabilistic<state_class, action_class, markov_chain, value_type, model_class
+    >::observe(const relearn::transition<link<state_class, action_class>>& arg)
+    {
+        if (!arg.last) {
+            __memory__.observe(arg.step.state, arg.step.action, arg.next.state);
+        }
+    }
+
+    template <class state_class,
+        class action_class,
+        typename markov_chain,
+        typename value_type,
+        class model_class>
+    template <class policy_class>
+    value_type q_probabilistic<state_class, action_class, markov_chain, value_type, model_class
+    >::operator()(const relearn::transition<link<state_class, action_class>>& arg,
+        policy_class& policy_map)
+    {
+        const value_type q = policy_map.value(arg.step.state, arg.step.action);
+        const value_type q_new = arg.last ? arg.step.state.reward()
+            : q_value(arg.step, arg.next, policy_map);
+        policy_map.update(arg.step.state, arg.step.action, q_new);
+        return q_new - q;
+    }
+
+    template <class state_class,
+        class action_class,
+        typename markov_chain,
+        typename value_type,
+        class model_class>
+    template <class policy_class,
+        typename reward_type>
+    void q_probabilistic<state_class, action_class, markov_chain, value_type, model_class
+    >::operator()(const transition_table<reward_type>& table,
+        policy_class& policy_map)
     {
-        for (unsigned int i = 0; i < episode.size(); i++) {
-            if (i == episode.size() - 1) continue;
-            __memory__[episode[i].state][episode[i].action][episode[i + 1].state] = +1;
+        table.for_each_pair([&](const transition_count<reward_type>* first,
+            const transition_count<reward_type>* last) {
+            policy_map.update_at(first->state, first->action, expected_value(first, last, policy_map));
+        });
+    }
+
+    template <class state_class,
+        class action_class,
+        typename markov_chain,
+        typename value_type,
+        class model_class>
+    template <class policy_class,
+        typename reward_type>
+    value_type q_probabilistic<state_class, action_class, markov_chain, value_type, model_class
+    >::expected_value(const transition_count<reward_type>* first,
+        const transition_count<reward_type>* last,
+        policy_class& policy_map)
+    {
+        // Σ P(s_t,a_t)(s_t+1) * (R(s_t+1) + γ * maxQ(s_t+1,a_t)), the last step of an episode is worth its reward
+        std::uint64_t total = 0;
+        for (const transition_count<reward_type>* it = first; it != last; ++it) {
+            total += it->count;
         }
-        for (unsigned int i = 0; i < episode.size(); i++) {
-            auto triplet = q_value(episode, i, policy_map);
-            policy_map.update(std::get<0>(triplet),
-                std::get<1>(triplet),
-                std::get<2>(triplet));
+        value_type retval = 0;
+        for (const transition_count<reward_type>* it = first; it != last; ++it) {
+            value_type q_next = 0;
+            if (!it->last) {
+                q_next = policy_map.best_value_at(it->next);
+                if (std::isnan(q_next)) q_next = 0.;
+            }
+            const value_type prob = static_cast<value_type>(it->count) / total;
+            retval += prob * (it->reward + gamma * q_next);
         }
+        return retval;
     }
 #ifdef USING_BOOST_SERIALIZATION
 #include "serialize.tpl"